@@ -0,0 +1,41 @@
+project "Benchmarks"
+	kind		    "ConsoleApp"
+	language	    "C++"
+	cppdialect	    "C++20"
+    systemversion 	"latest"
+
+	targetdir	("../bin/%{cfg.system}/%{cfg.architecture}/%{cfg.buildcfg}/%{prj.name}")
+	objdir		("../bin/intermediate/%{cfg.system}/%{cfg.architecture}/%{cfg.buildcfg}/%{prj.name}")
+
+	files
+	{
+		"src/**.h",
+		"src/**.cpp"
+	}
+
+	includedirs
+	{
+		"../OpenJSON/include"
+	}
+
+	links
+	{
+		"OpenJSON"
+	}
+
+	filter "system:linux"
+		buildoptions 
+		{
+			"-Wall"
+		}
+		links
+		{
+			"pthread"
+		}
+
+	filter "configurations:Debug"
+		symbols "On"
+        optimize "Off"		
+	filter "configurations:Release"
+        symbols "Off"
+		optimize "On"
\ No newline at end of file
@@ -0,0 +1,120 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+//////////////////////////////////////////////////////////////////////////
+//	helper functions
+//////////////////////////////////////////////////////////////////////////
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	size_t _i = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+	return sorted[std::min(_i, sorted.size() - 1)];
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	bench
+//////////////////////////////////////////////////////////////////////////
+
+bench_result bench_run(const std::string& corpus, const std::string& operation, size_t bytes, size_t ops,
+	const bench_options& options, const std::function<void()>& setup, const std::function<void()>& body)
+{
+	bench_result _r;
+	_r.corpus = corpus;
+	_r.operation = operation;
+	_r.bytes = bytes;
+	_r.ops = ops;
+	_r.repetitions = std::max<size_t>(options.repetitions, 1);
+
+	for (size_t i = 0; i < options.warmup; i++)
+	{
+		if (setup)
+			setup();
+		body();
+	}
+
+	std::vector<double> _times;
+	_times.reserve(_r.repetitions);
+	for (size_t i = 0; i < _r.repetitions; i++)
+	{
+		if (setup)
+			setup();
+		auto _start = std::chrono::steady_clock::now();
+		body();
+		auto _end = std::chrono::steady_clock::now();
+		_times.push_back((double)std::chrono::duration_cast<std::chrono::nanoseconds>(_end - _start).count());
+	}
+
+	std::sort(_times.begin(), _times.end());
+	double _sum = 0.0;
+	for (double t : _times)
+		_sum += t;
+	_r.min = _times.front();
+	_r.max = _times.back();
+	_r.mean = _sum / (double)_times.size();
+	_r.p50 = percentile(_times, 0.50);
+	_r.p90 = percentile(_times, 0.90);
+	_r.p99 = percentile(_times, 0.99);
+	return _r;
+}
+
+void bench_print_header(std::ostream& stream)
+{
+	stream << std::left << std::setw(10) << "corpus" << std::setw(12) << "operation"
+		<< std::right << std::setw(12) << "MB/s" << std::setw(14) << "ns/op"
+		<< std::setw(14) << "p50 (ms)" << std::setw(14) << "p90 (ms)" << std::setw(14) << "p99 (ms)" << "\n";
+}
+
+void bench_print(std::ostream& stream, const bench_result& result)
+{
+	stream << std::left << std::setw(10) << result.corpus << std::setw(12) << result.operation
+		<< std::right << std::fixed << std::setprecision(2)
+		<< std::setw(12) << result.mb_per_s() << std::setw(14) << result.ns_per_op()
+		<< std::setw(14) << result.p50 / 1e6 << std::setw(14) << result.p90 / 1e6 << std::setw(14) << result.p99 / 1e6 << "\n";
+	stream.unsetf(std::ios::floatfield);
+}
+
+void bench_save(const std::vector<bench_result>& results, const std::string& file)
+{
+	// written by hand : the results need more digits than the json writer prints
+	std::ofstream _s(file);
+	JSON_ASSERT(_s.is_open(), "cannot open file");
+
+	_s << std::fixed << std::setprecision(3);
+	_s << "{\n\t\"version\" : \"" << JSON_VERSION_MAJOR << "." << JSON_VERSION_MINOR << "." << JSON_VERSION_REVISION << "\",\n";
+	_s << "\t\"results\" : [";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const bench_result& r = results[i];
+		_s << (i > 0 ? ",\n\t\t{ " : "\n\t\t{ ");
+		_s << "\"corpus\" : \"" << r.corpus << "\", \"operation\" : \"" << r.operation << "\", ";
+		_s << "\"bytes\" : " << r.bytes << ", \"ops\" : " << r.ops << ", \"repetitions\" : " << r.repetitions << ", ";
+		_s << "\"mb_per_s\" : " << r.mb_per_s() << ", \"ns_per_op\" : " << r.ns_per_op() << ", ";
+		_s << "\"ns\" : { \"min\" : " << r.min << ", \"mean\" : " << r.mean << ", \"p50\" : " << r.p50
+			<< ", \"p90\" : " << r.p90 << ", \"p99\" : " << r.p99 << ", \"max\" : " << r.max << " } }";
+	}
+	_s << "\n\t]\n}\n";
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include <openjson.h>
+#include <functional>
+
+//////////////////////////////////////////////////////////////////////////
+//	corpora
+//////////////////////////////////////////////////////////////////////////
+
+struct bench_corpus
+{
+	std::string name;
+	std::string text;	// a json document, or one document per line
+	bool lines;			// ndjson
+};
+
+// deterministic generators, scale 1 gives about a megabyte per corpus
+bench_corpus make_twitter(size_t scale);	// string heavy
+bench_corpus make_canada(size_t scale);		// number heavy
+bench_corpus make_deep(size_t scale);		// deeply nested objects and arrays
+bench_corpus make_wide(size_t scale);		// one object with many members
+bench_corpus make_ndjson(size_t scale);		// small records, one per line
+
+//////////////////////////////////////////////////////////////////////////
+//	bench_result
+//////////////////////////////////////////////////////////////////////////
+
+struct bench_options
+{
+	size_t warmup = 2;
+	size_t repetitions = 10;
+};
+
+struct bench_result
+{
+	std::string corpus;
+	std::string operation;
+	size_t bytes = 0;		// bytes processed by one repetition
+	size_t ops = 0;			// operations performed by one repetition
+	size_t repetitions = 0;
+	double min = 0.0;		// nanoseconds per repetition
+	double mean = 0.0;
+	double p50 = 0.0;
+	double p90 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+
+	inline double mb_per_s() const { return p50 > 0.0 ? (double)bytes / p50 * 1000.0 : 0.0; }
+	inline double ns_per_op() const { return ops > 0 ? p50 / (double)ops : 0.0; }
+};
+
+// runs setup (untimed) then body (timed) warmup + repetitions times
+bench_result bench_run(const std::string& corpus, const std::string& operation, size_t bytes, size_t ops,
+	const bench_options& options, const std::function<void()>& setup, const std::function<void()>& body);
+
+void bench_print_header(std::ostream& stream);
+void bench_print(std::ostream& stream, const bench_result& result);
+void bench_save(const std::vector<bench_result>& results, const std::string& file);
+
+#endif //BENCH_H_INCLUDED
\ No newline at end of file
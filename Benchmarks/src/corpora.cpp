@@ -0,0 +1,216 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "bench.h"
+
+//////////////////////////////////////////////////////////////////////////
+//	helper functions
+//////////////////////////////////////////////////////////////////////////
+
+// xorshift64*, the corpora must be identical from one run to another
+struct bench_random
+{
+	uint64_t state;
+
+	bench_random(uint64_t seed) : state(seed) {}
+
+	uint64_t next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545f4914f6cdd1dull;
+	}
+
+	size_t range(size_t n) { return (size_t)(next() % n); }
+	double real() { return (double)(next() >> 11) / (double)(1ull << 53); }
+};
+
+static const char *g_words[] =
+{
+	"the", "json", "parser", "fast", "light", "value", "object", "array", "stream", "token",
+	"caf\\u00e9", "na\\\"ive", "line\\nbreak", "\\u65e5\\u672c", "tab\\there", "r\xc3\xa9sum\xc3\xa9", "\xe6\x9d\xb1\xe4\xba\xac",
+	"benchmark", "latency", "throughput", "memory", "config", "service", "request", "response"
+};
+
+static void append_words(std::string& out, bench_random& rnd, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		if (i > 0)
+			out += ' ';
+		out += g_words[rnd.range(sizeof(g_words) / sizeof(g_words[0]))];
+	}
+}
+
+static void append_number(std::string& out, double n, int precision)
+{
+	char _buf[64];
+	snprintf(_buf, sizeof(_buf), "%.*f", precision, n);
+	out += _buf;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	corpora
+//////////////////////////////////////////////////////////////////////////
+
+bench_corpus make_twitter(size_t scale)
+{
+	bench_random _rnd(0x7717);
+	bench_corpus _c = { "twitter", "", false };
+	std::string& s = _c.text;
+
+	s += "{\n\"statuses\": [";
+	for (size_t i = 0; i < 1500 * scale; i++)
+	{
+		if (i > 0)
+			s += ",";
+		s += "\n{ \"id\": " + std::to_string(100000 + i);
+		s += ", \"created_at\": \"Sun Aug 31 00:29:15 +0000 2014\", \"text\": \"";
+		append_words(s, _rnd, 12 + _rnd.range(20));
+		s += "\", \"source\": \"<a href=\\\"https://example.com/app\\\" rel=\\\"nofollow\\\">app<\\/a>\"";
+		s += ", \"user\": { \"id\": " + std::to_string(_rnd.range(1000000));
+		s += ", \"name\": \"";
+		append_words(s, _rnd, 2);
+		s += "\", \"screen_name\": \"user_" + std::to_string(_rnd.range(100000));
+		s += "\", \"description\": \"";
+		append_words(s, _rnd, 8 + _rnd.range(16));
+		s += "\", \"followers_count\": " + std::to_string(_rnd.range(50000));
+		s += ", \"verified\": " + std::string(_rnd.range(10) == 0 ? "true" : "false");
+		s += ", \"url\": null }";
+		s += ", \"entities\": { \"hashtags\": [";
+		size_t _tags = _rnd.range(4);
+		for (size_t t = 0; t < _tags; t++)
+		{
+			s += t > 0 ? ", \"" : "\"";
+			append_words(s, _rnd, 1);
+			s += "\"";
+		}
+		s += "], \"urls\": [] }";
+		s += ", \"retweet_count\": " + std::to_string(_rnd.range(1000));
+		s += ", \"favorited\": false, \"lang\": \"en\" }";
+	}
+	s += "\n],\n\"search_metadata\": { \"completed_in\": 0.087, \"count\": 100, \"query\": \"json\" }\n}";
+	return _c;
+}
+
+bench_corpus make_canada(size_t scale)
+{
+	bench_random _rnd(0xca7ada);
+	bench_corpus _c = { "canada", "", false };
+	std::string& s = _c.text;
+
+	s += "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},";
+	s += "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+	for (size_t r = 0; r < 30 * scale; r++)
+	{
+		s += r > 0 ? ",\n[" : "\n[";
+		for (size_t p = 0; p < 1000; p++)
+		{
+			s += p > 0 ? ",[" : "[";
+			append_number(s, -141.0 + 90.0 * _rnd.real(), 15);
+			s += ",";
+			append_number(s, 41.0 + 42.0 * _rnd.real(), 15);
+			s += "]";
+		}
+		s += "]";
+	}
+	s += "\n]}}]}";
+	return _c;
+}
+
+bench_corpus make_deep(size_t scale)
+{
+	bench_corpus _c = { "deep", "", false };
+	std::string& s = _c.text;
+	const size_t _depth = 256;
+
+	s += "{";
+	for (size_t i = 0; i < 64 * scale; i++)
+	{
+		s += i > 0 ? ",\n\"n" : "\n\"n";
+		s += std::to_string(i) + "\":";
+		for (size_t d = 0; d < _depth; d++)
+			s += "{\"v\":" + std::to_string(d) + ",\"next\":[";
+		s += "null";
+		for (size_t d = 0; d < _depth; d++)
+			s += "]}";
+	}
+	s += "\n}";
+	return _c;
+}
+
+bench_corpus make_wide(size_t scale)
+{
+	bench_random _rnd(0x171de);
+	bench_corpus _c = { "wide", "", false };
+	std::string& s = _c.text;
+
+	s += "{";
+	for (size_t i = 0; i < 4000 * scale; i++)
+	{
+		char _key[32];
+		snprintf(_key, sizeof(_key), "\"field_%06zu\": ", i);
+		s += i > 0 ? ",\n" : "\n";
+		s += _key;
+		switch (i % 4)
+		{
+		case 0:
+			s += std::to_string(_rnd.range(1000000));
+			break;
+		case 1:
+			s += "\"";
+			append_words(s, _rnd, 3);
+			s += "\"";
+			break;
+		case 2:
+			s += _rnd.range(2) ? "true" : "false";
+			break;
+		default:
+			append_number(s, _rnd.real() * 1000.0, 3);
+			break;
+		}
+	}
+	s += "\n}";
+	return _c;
+}
+
+bench_corpus make_ndjson(size_t scale)
+{
+	bench_random _rnd(0x1d15);
+	bench_corpus _c = { "ndjson", "", true };
+	std::string& s = _c.text;
+	static const char *_levels[] = { "debug", "info", "warn", "error" };
+
+	for (size_t i = 0; i < 20000 * scale; i++)
+	{
+		s += "{\"id\":" + std::to_string(i);
+		s += ",\"ts\":\"2021-06-0" + std::to_string(1 + i % 9) + "T12:00:00Z\"";
+		s += ",\"level\":\"" + std::string(_levels[_rnd.range(4)]) + "\"";
+		s += ",\"msg\":\"";
+		append_words(s, _rnd, 4 + _rnd.range(8));
+		s += "\",\"user\":{\"id\":" + std::to_string(_rnd.range(10000)) + ",\"name\":\"user_" + std::to_string(_rnd.range(10000)) + "\"}";
+		s += ",\"tags\":[\"api\",\"v2\"],\"latency\":";
+		append_number(s, _rnd.real() * 250.0, 2);
+		s += "}\n";
+	}
+	return _c;
+}
\ No newline at end of file
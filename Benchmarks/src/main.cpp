@@ -0,0 +1,347 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "bench.h"
+
+#include <sstream>
+
+//////////////////////////////////////////////////////////////////////////
+//	helper functions
+//////////////////////////////////////////////////////////////////////////
+
+static std::vector<std::string> split_lines(const std::string& text)
+{
+	std::vector<std::string> _lines;
+	size_t _start = 0;
+	while (_start < text.size())
+	{
+		size_t _end = text.find('\n', _start);
+		if (_end == std::string::npos)
+			_end = text.size();
+		if (_end > _start)
+			_lines.emplace_back(text, _start, _end - _start);
+		_start = _end + 1;
+	}
+	return _lines;
+}
+
+static void collect_keys(const json_var& var, std::vector<std::pair<const json_object*, std::string>>& keys)
+{
+	if (var.is_object())
+	{
+		const json_object& _obj = var.to_object();
+		for (size_t i = 0; i < _obj.count(); i++)
+		{
+			keys.emplace_back(&_obj, _obj.get_key(i));
+			collect_keys(_obj[i], keys);
+		}
+	}
+	else if (var.is_array())
+	{
+		const json_array& _arr = var.to_array();
+		for (size_t i = 0; i < _arr.count(); i++)
+			collect_keys(_arr[i], keys);
+	}
+}
+
+// touches every value through the iterators and json_visit
+static size_t traverse(const json_var& var)
+{
+	return json_visit(var, json_overloaded{
+		[](const json_object& obj)
+		{
+			size_t _sum = 0;
+			for (const auto& [key, value] : obj)
+				_sum += key.size() + traverse(value);
+			return _sum;
+		},
+		[](const json_array& arr)
+		{
+			// packed numbers are read where they are
+			size_t _sum = 0;
+			for (float n : arr.floats())
+				_sum += (size_t)(n != 0);
+			for (double n : arr.doubles())
+				_sum += (size_t)(n != 0);
+			for (int64_t n : arr.integers())
+				_sum += (size_t)(n != 0);
+			if (arr.is_packed())
+				return _sum;
+			for (const json_var& v : arr)
+				_sum += traverse(v);
+			return _sum;
+		},
+		[](const json_string& str) { return str.size(); },
+		[](json_number n) { return (size_t)(n != 0); },
+		[](json_boolean b) { return (size_t)b; },
+		[](std::nullptr_t) { return (size_t)0; } });
+}
+
+// a value halfway down the last members and the middle elements, reached
+// for writing
+static json_var& middle_value(json_var& var)
+{
+	if (var.is_object() && var.to_object().count() > 0)
+		return middle_value(var.to_object()[var.to_object().count() - 1]);
+	if (var.is_array() && var.to_array().count() > 0)
+		return middle_value(var.to_array()[var.to_array().count() / 2]);
+	return var;
+}
+
+static bool selected(const std::string& filter, const std::string& name)
+{
+	return filter.empty() || filter == name;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	suites
+//////////////////////////////////////////////////////////////////////////
+
+static void run_corpus(const bench_corpus& corpus, const std::string& op_filter, const bench_options& options, std::vector<bench_result>& results)
+{
+	std::vector<std::string> _texts = corpus.lines ? split_lines(corpus.text) : std::vector<std::string>{ corpus.text };
+	std::vector<json_var> _docs(_texts.size());
+	for (size_t i = 0; i < _texts.size(); i++)
+		if (!json_doc::load(_texts[i], _docs[i]))
+		{
+			std::cout << corpus.name << " : the corpus does not parse, skipped\n";
+			return;
+		}
+
+	std::vector<std::pair<const json_object*, std::string>> _keys;
+	for (const json_var& d : _docs)
+		collect_keys(d, _keys);
+
+	std::ostringstream _out;
+	for (const json_var& d : _docs)
+		_out << d;
+	size_t _serialized = _out.str().size();
+
+	std::vector<json_var> _holder(_docs.size());
+	volatile size_t _sink = 0;
+
+	auto _record = [&](const bench_result& r)
+	{
+		bench_print(std::cout, r);
+		results.push_back(r);
+	};
+
+	if (selected(op_filter, "parse"))
+		_record(bench_run(corpus.name, "parse", corpus.text.size(), _texts.size(), options,
+			[&]() { for (json_var& h : _holder) h = nullptr; },
+			[&]() { for (size_t i = 0; i < _texts.size(); i++) json_doc::load(_texts[i], _holder[i]); }));
+
+	// numbers kept as their text, converted by nobody
+	if (selected(op_filter, "lazyparse"))
+	{
+		json_doc::lazy_numbers = true;
+		_record(bench_run(corpus.name, "lazyparse", corpus.text.size(), _texts.size(), options,
+			[&]() { for (json_var& h : _holder) h = nullptr; },
+			[&]() { for (size_t i = 0; i < _texts.size(); i++) json_doc::load(_texts[i], _holder[i]); }));
+		json_doc::lazy_numbers = false;
+	}
+
+	// arrays of numbers made of json_vars, as before they were packed
+	if (selected(op_filter, "unpackedparse"))
+	{
+		json_doc::pack_numbers = false;
+		_record(bench_run(corpus.name, "unpackedparse", corpus.text.size(), _texts.size(), options,
+			[&]() { for (json_var& h : _holder) h = nullptr; },
+			[&]() { for (size_t i = 0; i < _texts.size(); i++) json_doc::load(_texts[i], _holder[i]); }));
+		json_doc::pack_numbers = true;
+	}
+
+	// steady state of a long lived parser: the trees of the previous run are overwritten
+	if (selected(op_filter, "reparse"))
+	{
+		json_parser _parser;
+		_record(bench_run(corpus.name, "reparse", corpus.text.size(), _texts.size(), options, nullptr,
+			[&]() { for (size_t i = 0; i < _texts.size(); i++) _parser.parse_into(_texts[i].c_str(), _texts[i].size(), _holder[i]); }));
+	}
+
+	if (selected(op_filter, "validate"))
+		_record(bench_run(corpus.name, "validate", corpus.text.size(), _texts.size(), options, nullptr,
+			[&]() { for (const std::string& t : _texts) _sink = _sink + json_doc::validate(t, json_doc::mode).offset; }));
+
+	// the first few members of the root of the first document
+	if (selected(op_filter, "project"))
+	{
+		json_projection _projection;
+		const json_object& _root = _docs[0].to_object();
+		for (size_t i = 0; i < _root.count() && i < 5; i++)
+			_projection.root().child(_root.get_key(i)).whole = true;
+		_record(bench_run(corpus.name, "project", corpus.text.size(), _texts.size(), options,
+			[&]() { for (json_var& h : _holder) h = nullptr; },
+			[&]() { for (size_t i = 0; i < _texts.size(); i++) json_doc::load(_texts[i], _holder[i], _projection); }));
+	}
+
+	// the error records of a hundred users out of the whole text, most lines rejected on their bytes
+	if (corpus.lines && selected(op_filter, "filter"))
+	{
+		json_filter _filter;
+		_filter.equal("/level", "error").range("/user/id", 0, 99);
+		_record(bench_run(corpus.name, "filter", corpus.text.size(), _texts.size(), options, nullptr,
+			[&]()
+			{
+				json_filter_reader _reader(_filter, std::string_view(corpus.text));
+				json_var _match;
+				while (_reader.next(_match))
+					_sink = _sink + 1;
+			}));
+	}
+
+	if (selected(op_filter, "serialize"))
+		_record(bench_run(corpus.name, "serialize", _serialized, _docs.size(), options, nullptr,
+			[&]() { std::ostringstream s; for (const json_var& d : _docs) s << d; _sink = _sink + s.tellp(); }));
+
+	// written again after a change through references kept from before the
+	// first write, with JSON_ENABLE_WRITE_CACHE the rest of the documents is
+	// copied from the kept bytes. the output is checked against fresh trees
+	// changed the same way.
+	if (selected(op_filter, "rewrite"))
+	{
+		std::vector<json_var> _edited(_texts.size());
+		std::vector<json_var*> _values;
+		for (size_t i = 0; i < _texts.size(); i++)
+		{
+			json_doc::load(_texts[i], _edited[i]);
+			_values.push_back(&middle_value(_edited[i]));
+		}
+		std::string _last;
+		json_number _round = 0;
+		_record(bench_run(corpus.name, "rewrite", _serialized, _docs.size(), options, nullptr,
+			[&]()
+			{
+				_round++;
+				for (json_var *v : _values)
+					*v = _round;
+				std::ostringstream s;
+				for (const json_var& d : _edited)
+					s << d;
+				_last = s.str();
+			}));
+
+		std::ostringstream _fresh;
+		for (const std::string& t : _texts)
+		{
+			json_var _doc;
+			json_doc::load(t, _doc);
+			middle_value(_doc) = _round;
+			_fresh << _doc;
+		}
+		if (_fresh.str() != _last)
+			std::cout << corpus.name << " : rewrite differs from a fresh serialization\n";
+	}
+
+	// same bytes as serialize, written on every hardware thread
+	if (selected(op_filter, "pserialize"))
+		_record(bench_run(corpus.name, "pserialize", _serialized, _docs.size(), options, nullptr,
+			[&]() { std::ostringstream s; for (const json_var& d : _docs) json_write_parallel(s, d); _sink = _sink + s.tellp(); }));
+
+	// compact output through json_stream_writer, the size differs from the indented one
+	if (selected(op_filter, "stream"))
+	{
+		std::string _compact;
+		{
+			json_stream_writer _w(_compact);
+			for (const json_var& d : _docs)
+				_w.value(d);
+		}
+		_record(bench_run(corpus.name, "stream", _compact.size(), _docs.size(), options, nullptr,
+			[&]() { std::string s; json_stream_writer w(s); for (const json_var& d : _docs) w.value(d); _sink = _sink + s.size(); }));
+	}
+
+	if (selected(op_filter, "lookup"))
+		_record(bench_run(corpus.name, "lookup", 0, _keys.size(), options, nullptr,
+			[&]() { for (const auto& k : _keys) _sink = _sink + (size_t)k.first->get(k.second).type; }));
+
+	if (selected(op_filter, "traverse"))
+		_record(bench_run(corpus.name, "traverse", corpus.text.size(), _docs.size(), options, nullptr,
+			[&]() { for (const json_var& d : _docs) _sink = _sink + traverse(d); }));
+
+	if (selected(op_filter, "copy"))
+		_record(bench_run(corpus.name, "copy", corpus.text.size(), _docs.size(), options,
+			[&]() { for (json_var& h : _holder) h = nullptr; },
+			[&]() { for (size_t i = 0; i < _docs.size(); i++) _holder[i] = _docs[i]; }));
+
+	if (selected(op_filter, "teardown"))
+		_record(bench_run(corpus.name, "teardown", corpus.text.size(), _docs.size(), options,
+			[&]() { for (size_t i = 0; i < _texts.size(); i++) json_doc::load(_texts[i], _holder[i]); },
+			[&]() { for (json_var& h : _holder) h = nullptr; }));
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	main
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv)
+{
+	bench_options _options;
+	size_t _scale = 1;
+	std::string _corpus, _op, _file = "benchmark_results.json";
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string _arg = argv[i];
+		std::string _next = i + 1 < argc ? argv[i + 1] : "";
+		if (_arg == "--scale" && !_next.empty())
+			_scale = std::max(1, std::atoi(argv[++i]));
+		else if (_arg == "--reps" && !_next.empty())
+			_options.repetitions = (size_t)std::max(1, std::atoi(argv[++i]));
+		else if (_arg == "--warmup" && !_next.empty())
+			_options.warmup = (size_t)std::max(0, std::atoi(argv[++i]));
+		else if (_arg == "--corpus" && !_next.empty())
+			_corpus = argv[++i];
+		else if (_arg == "--op" && !_next.empty())
+			_op = argv[++i];
+		else if (_arg == "--out" && !_next.empty())
+			_file = argv[++i];
+		else
+		{
+			std::cout << "usage : Benchmarks [--scale n] [--reps n] [--warmup n] [--corpus name] [--op name] [--out file]\n"
+				"corpora : twitter canada deep wide ndjson\n"
+				"operations : parse lazyparse unpackedparse reparse validate project filter serialize rewrite pserialize stream lookup traverse copy teardown\n";
+			return 1;
+		}
+	}
+
+	json_doc::mode = parse_mode::strict;
+
+	std::vector<bench_result> _results;
+	bench_print_header(std::cout);
+
+	typedef bench_corpus (*make_corpus)(size_t);
+	const std::pair<const char*, make_corpus> _corpora[] =
+	{
+		{ "twitter", make_twitter },
+		{ "canada", make_canada },
+		{ "deep", make_deep },
+		{ "wide", make_wide },
+		{ "ndjson", make_ndjson }
+	};
+	for (const auto& c : _corpora)
+		if (selected(_corpus, c.first))
+			run_corpus(c.second(_scale), _op, _options, _results);
+
+	bench_save(_results, _file);
+	std::cout << "results written to " << _file << "\n";
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_CACHE_H_INCLUDED
+#define JSON_CACHE_H_INCLUDED
+
+#include "json_vars.h"
+#include "json_parser.h"
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+// memory the documents of a json_cache may take by default
+#if !defined(JSON_CACHE_BUDGET)
+	#define JSON_CACHE_BUDGET (256 << 20)
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//	json_cache
+//////////////////////////////////////////////////////////////////////////
+
+// the version of a file a document was parsed from
+struct json_file_stamp
+{
+	int64_t mtime = 0;		// in nanoseconds where the system keeps them
+	uint64_t size = 0;
+	uint64_t inode = 0;
+
+	bool operator==(const json_file_stamp& stamp) const { return mtime == stamp.mtime && size == stamp.size && inode == stamp.inode; }
+	bool operator!=(const json_file_stamp& stamp) const { return !(*this == stamp); }
+};
+
+// reads the stamp of file, returns false when it cannot be read
+bool json_file_stamp_of(const char *file, json_file_stamp& stamp);
+
+struct json_cache_entry;
+
+// parsed documents by path. a file is parsed again only when its
+// modification time, size or inode changed, threads asking for a file
+// that is being parsed wait for that parse instead of starting their own.
+// the documents are handed out read-only and shared, a handle keeps its
+// document alive after it is evicted or replaced. the least recently used
+// documents are evicted when the estimated memory of the cached trees goes
+// over the budget. the files are parsed in json_doc::mode, failures are
+// not cached. every member can be called from any thread.
+class json_cache
+{
+public:
+	typedef std::shared_ptr<const json_var> handle;
+
+private:
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, std::shared_ptr<json_cache_entry>> m_entries;
+	std::list<json_cache_entry*> m_lru;		// loaded entries, most recently used first
+	size_t m_budget;
+	size_t m_memory;
+	size_t m_hits;
+	size_t m_misses;
+
+	void evict(const json_cache_entry *keep);
+	void erase(const std::string& file);
+
+public:
+	json_cache(size_t budget = JSON_CACHE_BUDGET);
+	json_cache(const json_cache&) = delete;
+	~json_cache();
+
+	// nullptr when the file does not load
+	handle get(const std::string& file);
+	handle get(const std::string& file, json_parse_result& result);
+
+	// forgets a file, or every file. handed out documents are not affected.
+	void remove(const std::string& file);
+	void clear();
+
+	void set_budget(size_t bytes);
+	size_t budget() const;
+	size_t memory() const;		// estimated size of the cached trees
+	size_t count() const;
+	size_t hits() const;
+	size_t misses() const;		// parses, a waiter on a parse counts as a hit
+};
+
+// estimated heap size of a tree, the nodes shared with other trees included
+size_t json_memory_of(const json_var& var);
+
+#endif //JSON_CACHE_H_INCLUDED
\ No newline at end of file
@@ -1,58 +1,105 @@
-/*
-
-Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
-
-This file is part of OpenJSON.
-
-OpenJSON is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or
-(at your option) any later version.
-
-OpenJSON is distributed in the hope that it will be useful,
-but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License
-along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
-
-*/
-
-#ifndef JSON_DOC_H_INCLUDED
-#define JSON_DOC_H_INCLUDED
-
-#include "json_vars.h"
-
-enum class parse_mode
-{
-	strict,
-	permissive
-};
-
-class json_doc
-{
-private:
-	json_doc() {}
-	json_doc(const json_doc&) = delete;
-	~json_doc() {}
-
-public:
-	static parse_mode mode;
-
-	static void save(json_object& obj, const char *file);
-	static void save(json_object& obj, const std::string& file);
-	static bool load_file(const char *file, json_object& obj);
-	static bool load_file(const std::string& file, json_object& obj);
-	static bool load(const char *str, json_object& obj);
-	static bool load(const std::string& str, json_object& obj);
-
-	static bool load_file(const char *file, json_var& var);
-	static bool load_file(const std::string& file, json_var& var);
-	static bool load(const char *str, json_var& var);
-	static bool load(const std::string& str, json_var& var);
-};
-
-json_object operator""_json(const char *str, size_t size);
-
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_DOC_H_INCLUDED
+#define JSON_DOC_H_INCLUDED
+
+#include "json_vars.h"
+#include "json_parser.h"
+#include "json_validate.h"
+#include "json_loader.h"
+#include "json_cache.h"
+#include "json_parallel_writer.h"
+#include "json_literal.h"
+#include "json_stats.h"
+
+class json_doc
+{
+private:
+	json_doc() {}
+	json_doc(const json_doc&) = delete;
+	~json_doc() {}
+
+public:
+	static parse_mode mode;
+	static size_t max_depth;	// see json_parser::max_depth
+	static bool lazy_numbers;	// see json_parser::lazy_numbers
+	static bool pack_numbers;	// see json_parser::pack_numbers
+
+	// save and load_file return false when the file cannot be opened, or
+	// written, or when the document does not parse
+	static bool save(const json_object& obj, const char *file);
+	static bool save(const json_object& obj, const std::string& file);
+	static bool load_file(const char *file, json_object& obj);
+	static bool load_file(const std::string& file, json_object& obj);
+	static bool load(const char *str, json_object& obj);
+	static bool load(const std::string& str, json_object& obj);
+
+	static bool load_file(const char *file, json_var& var);
+	static bool load_file(const std::string& file, json_var& var);
+	static bool load(const char *str, json_var& var);
+	static bool load(const std::string& str, json_var& var);
+
+	// loads only the members in the projection (see json_projection.h)
+	static bool load(const char *str, json_var& var, const json_projection& projection);
+	static bool load(const std::string& str, json_var& var, const json_projection& projection);
+
+	// same as above, the work done is added to stats (see json_stats.h)
+	static bool save(const json_object& obj, const char *file, json_stats& stats);
+	static bool save(const json_object& obj, const std::string& file, json_stats& stats);
+	static bool load_file(const char *file, json_var& var, json_stats& stats);
+	static bool load_file(const std::string& file, json_var& var, json_stats& stats);
+	static bool load(const char *str, json_var& var, json_stats& stats);
+	static bool load(const std::string& str, json_var& var, json_stats& stats);
+
+	// same as above, why the document did not load is kept in result. the
+	// line and column of an error in a file are counted before it is closed.
+	static bool load_file(const char *file, json_var& var, json_parse_result& result);
+	static bool load_file(const std::string& file, json_var& var, json_parse_result& result);
+	static bool load(const char *str, json_var& var, json_parse_result& result);
+	static bool load(const std::string& str, json_var& var, json_parse_result& result);
+
+	// same as above, the document also has to match schema, it is checked
+	// while it is parsed (see json_schema.h). result tells why it did not load.
+	static bool load_file(const char *file, json_var& var, const json_schema& schema, json_schema_result& result);
+	static bool load_file(const std::string& file, json_var& var, const json_schema& schema, json_schema_result& result);
+	static bool load(const char *str, json_var& var, const json_schema& schema, json_schema_result& result);
+	static bool load(const std::string& str, json_var& var, const json_schema& schema, json_schema_result& result);
+
+	// checks the document without building it (see json_validate.h)
+	static json_validate_result validate(const char *buf, size_t length, parse_mode mode);
+	static json_validate_result validate(const std::string& str, parse_mode mode);
+
+	// writes the document on worker threads (see json_parallel_writer.h)
+	static bool save(const json_object& obj, const char *file, const json_write_options& options);
+	static bool save(const json_object& obj, const std::string& file, const json_write_options& options);
+
+	// reads and parses many files on worker threads (see json_loader.h)
+	static std::vector<json_load_result> load_files(const std::vector<std::string>& paths, const json_load_options& options = {});
+
+	// the document in file, parsed once per version of the file and shared
+	// by every caller, from a cache of the process (see json_cache.h)
+	static json_cache& cache();
+	static json_cache::handle load_cached(const std::string& file);
+	static json_cache::handle load_cached(const std::string& file, json_parse_result& result);
+};
+
 #endif //JSON_DOC_H_INCLUDED
\ No newline at end of file
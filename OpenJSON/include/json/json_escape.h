@@ -0,0 +1,46 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_ESCAPE_H_INCLUDED
+#define JSON_ESCAPE_H_INCLUDED
+
+#include "core.h"
+
+// number of bytes at the start of str that can be copied as they are, the
+// run ends on the quote, a backslash or a control character
+size_t json_plain_length(const char *str, size_t length, char quote = '\"');
+
+// offset of the first occurrence of needle in str, length when there is
+// none. candidates are the positions holding both the first and the last
+// byte of the needle, compared 16 at a time, the rest is compared on those.
+size_t json_find(const char *str, size_t length, const char *needle, size_t needle_length);
+
+// decodes the hex digits of a \u escape, str points right after the 'u'. a
+// high surrogate has to be followed by the escape of its low surrogate, the
+// pair is decoded as one code point. the UTF-8 is appended to out, returns
+// the number of bytes used from str or 0 if the escape is not valid
+size_t json_unescape_unicode(const char *str, size_t length, std::string& out);
+
+// writes str between double quotes with the escapes JSON requires
+void json_write_string(std::ostream& stream, const char *str, size_t length);
+void json_append_string(std::string& out, const char *str, size_t length);
+
+#endif //JSON_ESCAPE_H_INCLUDED
\ No newline at end of file
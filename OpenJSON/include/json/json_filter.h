@@ -0,0 +1,182 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_FILTER_H_INCLUDED
+#define JSON_FILTER_H_INCLUDED
+
+#include "json_parser.h"
+#include <string_view>
+#include <type_traits>
+
+// bytes read from a file at once by json_filter_reader, a longer line
+// grows the buffer until it fits
+#if !defined(JSON_FILTER_CHUNK)
+#define JSON_FILTER_CHUNK (1 << 20)
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//	json_predicate
+//////////////////////////////////////////////////////////////////////////
+
+enum class json_predicate_type : uint8_t
+{
+	equal,		// the value equals the given one, a number is a range from it to itself
+	prefix,		// a string starting with the given text
+	range,		// a number between min and max, both included
+	exists		// any value, null included
+};
+
+// a test on the values at a path, a JSON Pointer where "*" stands for
+// every member of an object and every element of an array. it holds when
+// one of the values there passes.
+struct json_predicate
+{
+	json_predicate_type type;
+	std::vector<std::string> path;
+	json_var value;		// equal
+	std::string text;	// prefix
+	double min = 0.0;	// range
+	double max = 0.0;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_filter
+//////////////////////////////////////////////////////////////////////////
+
+// selects the records of NDJSON for which every predicate holds, without
+// parsing most of the others. a line is first searched for bytes every
+// match contains: the quoted keys of the paths, the quoted strings and the
+// literals compared to, the quote and the text of a prefix. the lines that
+// have them all are parsed, only for the members the predicates read (see
+// json_projection), and tested. a line with a backslash in it may spell
+// its keys and strings with escapes, it is not rejected on those.
+class json_filter
+{
+private:
+	friend class json_filter_reader;
+
+	std::vector<json_predicate> m_predicates;
+	json_projection m_projection;
+	std::vector<std::string> m_literals;	// true, false and null, found in every candidate
+	std::vector<std::string> m_needles;		// keys and strings, unless the line has escapes
+
+	json_filter& add(json_predicate predicate, std::string_view pointer);
+	void add_needle(std::vector<std::string>& needles, std::string needle);
+	// the members read by the predicates parsed into scratch, then tested
+	bool test(const char *line, size_t length, json_parser& parser, json_var& scratch) const;
+
+public:
+	json_filter() {}
+
+	json_filter& equal(std::string_view pointer, const json_var& value);
+	template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	inline json_filter& equal(std::string_view pointer, T value)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			return equal(pointer, json_var(value));
+		else
+			return range(pointer, (double)value, (double)value);
+	}
+	json_filter& prefix(std::string_view pointer, std::string_view text);
+	json_filter& range(std::string_view pointer, double min, double max);
+	json_filter& exists(std::string_view pointer);
+
+	// false when the text of a line cannot match, it is taken as strict
+	// JSON. true does not mean it matches.
+	bool prescan(const char *line, size_t length) const;
+
+	// the predicates tested on a record
+	bool match(const json_var& record) const;
+	// the prescan, then the members read by the predicates parsed into
+	// scratch and tested. a line that does not parse does not match, see
+	// parser.result(). parse_mode::permissive skips the prescan.
+	bool match(const char *line, size_t length, json_parser& parser, json_var& scratch) const;
+
+	inline const std::vector<json_predicate>& predicates() const { return m_predicates; }
+	inline const json_projection& projection() const { return m_projection; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_filter_reader
+//////////////////////////////////////////////////////////////////////////
+
+// the records of NDJSON matching a filter, read from a buffer or from a
+// file a chunk at a time. empty lines are skipped, candidates that do not
+// parse are skipped and counted. lines the prescan rejects are not parsed
+// at all, errors in them go unnoticed.
+class json_filter_reader
+{
+private:
+	const json_filter& m_filter;
+	json_parser m_parser;
+	json_var m_scratch;
+
+	std::ifstream m_file;
+	bool m_more = false;	// the file has not been read to the end
+	std::string m_buffer;
+
+	const char *m_data = nullptr;
+	size_t m_length = 0;
+	size_t m_pos = 0;
+	std::string_view m_line;
+
+	size_t m_lines = 0;
+	size_t m_candidates = 0;
+	size_t m_matches = 0;
+	size_t m_errors = 0;
+
+	bool next_line();
+
+	struct file_tag {};
+	json_filter_reader(const json_filter& filter, file_tag, const std::string& file);
+
+public:
+	// the buffer has to outlive the reader
+	json_filter_reader(const json_filter& filter, const char *data, size_t length);
+	json_filter_reader(const json_filter& filter, std::string_view data);
+	json_filter_reader(const json_filter_reader&) = delete;
+
+	// reads the file a chunk at a time, named apart so a buffer held in a
+	// std::string is never taken for a file name
+	static json_filter_reader from_file(const json_filter& filter, const std::string& file);
+
+	// false when the file could not be opened
+	inline bool is_open() const { return m_data != nullptr || m_more; }
+
+	// parses the next matching record into record, false at the end. the
+	// record is tested again once parsed whole, match(record) holds for it.
+	bool next(json_var& record);
+
+	// the text of the last record, valid until the next call
+	inline std::string_view line() const { return m_line; }
+
+	// lines read so far, the last record is on the last of them, lines
+	// that passed the prescan, records returned and lines that did not parse
+	inline size_t lines() const { return m_lines; }
+	inline size_t candidates() const { return m_candidates; }
+	inline size_t matches() const { return m_matches; }
+	inline size_t errors() const { return m_errors; }
+
+	// parses the records, its mode and options apply to them
+	inline json_parser& parser() { return m_parser; }
+};
+
+#endif //JSON_FILTER_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,518 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_LITERAL_H_INCLUDED
+#define JSON_LITERAL_H_INCLUDED
+
+#include "json_vars.h"
+
+//////////////////////////////////////////////////////////////////////////
+//	json_literal_string
+//////////////////////////////////////////////////////////////////////////
+
+template <size_t N>
+struct json_literal_string
+{
+	char data[N];
+
+	constexpr json_literal_string(const char (&str)[N])
+		: data()
+	{
+		for (size_t i = 0; i < N; i++)
+			data[i] = str[i];
+	}
+
+	constexpr size_t size() const { return N - 1; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_literal_node
+//////////////////////////////////////////////////////////////////////////
+
+// one value of a literal, stored in pre-order. strings, keys and the text
+// of numbers are offsets into the character pool of the table that owns
+// the node.
+struct json_literal_node
+{
+	json_type type = json_type::null;
+	json_boolean boolean = false;
+	size_t key = 0;
+	size_t key_length = 0;
+	size_t string = 0;
+	size_t string_length = 0;
+	size_t count = 0;	// direct children
+	size_t size = 1;	// nodes in the subtree, this one included
+};
+
+template <size_t Nodes, size_t Chars>
+struct json_literal_table
+{
+	json_literal_node nodes[Nodes];
+	char chars[Chars + 1];
+};
+
+// never defined as constexpr : reaching it while evaluating a literal
+// stops the compilation and the message ends up in the diagnostic
+void json_literal_error(const char *message);
+
+//////////////////////////////////////////////////////////////////////////
+//	json_literal_parser
+//////////////////////////////////////////////////////////////////////////
+
+// compile time parser for the permissive grammar (the parsing mode is a
+// runtime setting so literals accept comments and single quoted strings).
+// without output buffers it only validates and measures the literal.
+struct json_literal_parser
+{
+	const char *src;
+	size_t length;
+	size_t pos = 0;
+	json_literal_node *nodes = nullptr;
+	char *chars = nullptr;
+	size_t node_count = 0;
+	size_t char_count = 0;
+
+	constexpr json_literal_parser(const char *str, size_t len, json_literal_node *n = nullptr, char *c = nullptr)
+		: src(str), length(len), nodes(n), chars(c)
+	{
+	}
+
+	constexpr char peek() const { return pos < length ? src[pos] : '\0'; }
+
+	constexpr void skip()
+	{
+		while (pos < length)
+		{
+			char c = src[pos];
+			if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+				pos++;
+			else if (c == '/' && pos + 1 < length && src[pos + 1] == '/')
+			{
+				while (pos < length && src[pos] != '\n' && src[pos] != '\r')
+					pos++;
+			}
+			else if (c == '/' && pos + 1 < length && src[pos + 1] == '*')
+			{
+				pos += 2;
+				while (pos + 1 < length && !(src[pos] == '*' && src[pos + 1] == '/'))
+					pos++;
+				if (pos + 1 >= length)
+					json_literal_error("unterminated comment");
+				pos += 2;
+			}
+			else
+				break;
+		}
+	}
+
+	constexpr void expect(char c, const char *message)
+	{
+		skip();
+		if (peek() != c)
+			json_literal_error(message);
+		pos++;
+	}
+
+	constexpr size_t add_node(json_type type, size_t key, size_t key_length)
+	{
+		size_t _i = node_count++;
+		if (nodes != nullptr)
+		{
+			nodes[_i] = json_literal_node();
+			nodes[_i].type = type;
+			nodes[_i].key = key;
+			nodes[_i].key_length = key_length;
+		}
+		return _i;
+	}
+
+	constexpr void put(char c)
+	{
+		if (chars != nullptr)
+			chars[char_count] = c;
+		char_count++;
+	}
+
+	constexpr void put_utf8(uint32_t cp)
+	{
+		if (cp < 0x80)
+			put((char)cp);
+		else if (cp < 0x800)
+		{
+			put((char)(0xc0 | (cp >> 6)));
+			put((char)(0x80 | (cp & 0x3f)));
+		}
+		else if (cp < 0x10000)
+		{
+			put((char)(0xe0 | (cp >> 12)));
+			put((char)(0x80 | ((cp >> 6) & 0x3f)));
+			put((char)(0x80 | (cp & 0x3f)));
+		}
+		else
+		{
+			put((char)(0xf0 | (cp >> 18)));
+			put((char)(0x80 | ((cp >> 12) & 0x3f)));
+			put((char)(0x80 | ((cp >> 6) & 0x3f)));
+			put((char)(0x80 | (cp & 0x3f)));
+		}
+	}
+
+	constexpr uint32_t hex4()
+	{
+		uint32_t _cp = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char c = peek();
+			pos++;
+			if (c >= '0' && c <= '9')
+				_cp = (_cp << 4) | (uint32_t)(c - '0');
+			else if (c >= 'a' && c <= 'f')
+				_cp = (_cp << 4) | (uint32_t)(c - 'a' + 10);
+			else if (c >= 'A' && c <= 'F')
+				_cp = (_cp << 4) | (uint32_t)(c - 'A' + 10);
+			else
+				json_literal_error("invalid \\u escape");
+		}
+		return _cp;
+	}
+
+	constexpr void parse_string(size_t& offset, size_t& size)
+	{
+		char _quote = peek();
+		if (_quote != '\"' && _quote != '\'')
+			json_literal_error("expected a string");
+		pos++;
+		offset = char_count;
+		for (;;)
+		{
+			if (pos >= length)
+				json_literal_error("unterminated string");
+			char c = src[pos++];
+			if (c == _quote)
+				break;
+			if ((c >= 0x00 && c <= 0x1f) || c == 0x7f)
+				json_literal_error("control character in string value");
+			if (c != '\\')
+			{
+				put(c);
+				continue;
+			}
+			c = peek();
+			pos++;
+			if (c == '\"' || c == '\\' || c == '/')
+				put(c);
+			else if (c == 'b')
+				put('\b');
+			else if (c == 'f')
+				put('\f');
+			else if (c == 'n')
+				put('\n');
+			else if (c == 'r')
+				put('\r');
+			else if (c == 't')
+				put('\t');
+			else if (c == 'u')
+			{
+				uint32_t _cp = hex4();
+				if (_cp >= 0xd800 && _cp <= 0xdbff)
+				{
+					if (peek() != '\\' || pos + 1 >= length || src[pos + 1] != 'u')
+						json_literal_error("unpaired surrogate");
+					pos += 2;
+					uint32_t _low = hex4();
+					if (_low < 0xdc00 || _low > 0xdfff)
+						json_literal_error("unpaired surrogate");
+					_cp = 0x10000 + ((_cp - 0xd800) << 10) + (_low - 0xdc00);
+				}
+				else if (_cp >= 0xdc00 && _cp <= 0xdfff)
+					json_literal_error("unpaired surrogate");
+				put_utf8(_cp);
+			}
+			else
+				json_literal_error("unknown escape sequence");
+		}
+		size = char_count - offset;
+	}
+
+	// the literal only checks the number and keeps its text in the pool, it
+	// is converted when materialized with the strtof the runtime parser uses
+	// so both read the same float. the text is followed by a '\0' for strtof.
+	constexpr void parse_number(size_t& offset, size_t& size)
+	{
+		// the smallest magnitude that rounds to infinity as a float, 2^128 - 2^103,
+		// numbers from there on are refused like the parser does
+		constexpr const char *_limit = "340282356779733661637539395458142568448";
+		constexpr int _limit_digits = 39;
+		char _significant[_limit_digits] = {};
+		int _count = 0;		// significant digits seen
+		long _leading = 0;	// decimal exponent of the first significant digit
+
+		offset = char_count;
+		auto digit = [&](bool fraction)
+		{
+			const char c = src[pos++];
+			put(c);
+			if (_count == 0 && fraction)
+				_leading--;
+			else if (_count > 0 && !fraction)
+				_leading++;
+			if (_count == 0 && c == '0')
+				return;
+			if (_count < _limit_digits)
+				_significant[_count] = c;
+			_count++;
+		};
+
+		if (peek() == '-')
+			put(src[pos++]);
+		if (!(peek() >= '0' && peek() <= '9'))
+			json_literal_error("expected a digit");
+		while (peek() >= '0' && peek() <= '9')
+			digit(false);
+		if (peek() == '.')
+		{
+			put(src[pos++]);
+			if (!(peek() >= '0' && peek() <= '9'))
+				json_literal_error("expected a digit");
+			while (peek() >= '0' && peek() <= '9')
+				digit(true);
+		}
+		long _exponent = 0;
+		if (peek() == 'e' || peek() == 'E')
+		{
+			put(src[pos++]);
+			bool _negative_exponent = false;
+			if (peek() == '-' || peek() == '+')
+			{
+				_negative_exponent = peek() == '-';
+				put(src[pos++]);
+			}
+			if (!(peek() >= '0' && peek() <= '9'))
+				json_literal_error("expected a digit");
+			while (peek() >= '0' && peek() <= '9')
+			{
+				if (_exponent < 100000)
+					_exponent = _exponent * 10 + (peek() - '0');
+				put(src[pos++]);
+			}
+			if (_negative_exponent)
+				_exponent = -_exponent;
+		}
+		size = char_count - offset;
+		put('\0');
+
+		if (_count == 0)
+			return;
+		_exponent += _leading;
+		bool _over = _exponent > _limit_digits - 1;
+		if (_exponent == _limit_digits - 1)
+		{
+			int i = 0;
+			while (i < _limit_digits && (_significant[i] != '\0' ? _significant[i] : '0') == _limit[i])
+				i++;
+			_over = i == _limit_digits || (_significant[i] != '\0' ? _significant[i] : '0') > _limit[i];
+		}
+		if (_over)
+			json_literal_error("number out of range");
+	}
+
+	constexpr bool match(const char *word)
+	{
+		size_t _n = 0;
+		while (word[_n] != '\0')
+		{
+			if (pos + _n >= length || src[pos + _n] != word[_n])
+				return false;
+			_n++;
+		}
+		char c = pos + _n < length ? src[pos + _n] : '\0';
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+			return false;
+		pos += _n;
+		return true;
+	}
+
+	constexpr void parse_value(size_t key, size_t key_length)
+	{
+		skip();
+		char c = peek();
+		if (c == '{')
+			parse_object(key, key_length);
+		else if (c == '[')
+			parse_array(key, key_length);
+		else if (c == '\"' || c == '\'')
+		{
+			size_t _offset = 0, _size = 0;
+			parse_string(_offset, _size);
+			size_t _i = add_node(json_type::string, key, key_length);
+			if (nodes != nullptr)
+			{
+				nodes[_i].string = _offset;
+				nodes[_i].string_length = _size;
+			}
+		}
+		else if (c == '-' || (c >= '0' && c <= '9'))
+		{
+			size_t _offset = 0, _size = 0;
+			parse_number(_offset, _size);
+			size_t _i = add_node(json_type::number, key, key_length);
+			if (nodes != nullptr)
+			{
+				nodes[_i].string = _offset;
+				nodes[_i].string_length = _size;
+			}
+		}
+		else if (match("true"))
+		{
+			size_t _i = add_node(json_type::boolean, key, key_length);
+			if (nodes != nullptr)
+				nodes[_i].boolean = true;
+		}
+		else if (match("false"))
+			add_node(json_type::boolean, key, key_length);
+		else if (match("null"))
+			add_node(json_type::null, key, key_length);
+		else
+			json_literal_error("unexpected character");
+	}
+
+	constexpr void parse_object(size_t key, size_t key_length)
+	{
+		size_t _self = add_node(json_type::object, key, key_length);
+		size_t _count = 0;
+		expect('{', "expected '{'");
+		skip();
+		if (peek() == '}')
+			pos++;
+		else
+		{
+			for (;;)
+			{
+				size_t _key = 0, _key_length = 0;
+				skip();
+				parse_string(_key, _key_length);
+				expect(':', "expected ':'");
+				parse_value(_key, _key_length);
+				_count++;
+				skip();
+				if (peek() != ',')
+					break;
+				pos++;
+			}
+			expect('}', "expected ',' or '}'");
+		}
+		if (nodes != nullptr)
+		{
+			nodes[_self].count = _count;
+			nodes[_self].size = node_count - _self;
+		}
+	}
+
+	constexpr void parse_array(size_t key, size_t key_length)
+	{
+		size_t _self = add_node(json_type::array, key, key_length);
+		size_t _count = 0;
+		expect('[', "expected '['");
+		skip();
+		if (peek() == ']')
+			pos++;
+		else
+		{
+			for (;;)
+			{
+				parse_value(0, 0);
+				_count++;
+				skip();
+				if (peek() != ',')
+					break;
+				pos++;
+			}
+			expect(']', "expected ',' or ']'");
+		}
+		if (nodes != nullptr)
+		{
+			nodes[_self].count = _count;
+			nodes[_self].size = node_count - _self;
+		}
+	}
+
+	constexpr void parse_document()
+	{
+		skip();
+		if (peek() != '{')
+			json_literal_error("a json document must be an object");
+		parse_value(0, 0);
+		skip();
+		if (pos != length)
+			json_literal_error("unexpected character after the document");
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	compile time construction
+//////////////////////////////////////////////////////////////////////////
+
+struct json_literal_info
+{
+	size_t nodes;
+	size_t chars;
+};
+
+constexpr json_literal_info json_literal_scan(const char *str, size_t size)
+{
+	json_literal_parser _p(str, size);
+	_p.parse_document();
+	return { _p.node_count, _p.char_count };
+}
+
+template <size_t Nodes, size_t Chars>
+constexpr json_literal_table<Nodes, Chars> json_literal_build(const char *str, size_t size)
+{
+	json_literal_table<Nodes, Chars> _table{};
+	json_literal_parser _p(str, size, _table.nodes, _table.chars);
+	_p.parse_document();
+	return _table;
+}
+
+template <json_literal_string S>
+struct json_literal_data
+{
+	static constexpr json_literal_info info = json_literal_scan(S.data, S.size());
+	static constexpr json_literal_table<info.nodes, info.chars> table = json_literal_build<info.nodes, info.chars>(S.data, S.size());
+};
+
+// builds a json_object out of a validated table, no lexing involved
+json_object json_literal_materialize(const json_literal_node *nodes, const char *chars);
+
+//////////////////////////////////////////////////////////////////////////
+//	operators
+//////////////////////////////////////////////////////////////////////////
+
+// validated and laid out at compile time, materialized once on first use.
+// binding the result to a const reference costs nothing after that.
+template <json_literal_string S>
+const json_object& operator""_json()
+{
+	static const json_object _obj = json_literal_materialize(json_literal_data<S>::table.nodes, json_literal_data<S>::table.chars);
+	return _obj;
+}
+
+#endif //JSON_LITERAL_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,49 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_LOADER_H_INCLUDED
+#define JSON_LOADER_H_INCLUDED
+
+#include "json_vars.h"
+
+struct json_load_options
+{
+	size_t io_threads = 2;					// threads reading files ahead of the parsers
+	size_t parse_threads = 0;				// 0 for one per hardware thread
+	size_t max_buffered_bytes = 64 << 20;	// file contents read but not parsed yet
+};
+
+struct json_load_result
+{
+	json_var doc;
+	bool success = false;
+	const char *error = nullptr;	// why the file did not load
+};
+
+// loads every file in paths, reading and parsing them on worker threads so
+// that the disk is kept busy while the documents are parsed. readers wait
+// when max_buffered_bytes are read and not parsed yet, a file larger than
+// that is still read once nothing else is buffered. the results are in the
+// order of paths, parsed in the given mode. the trees are allocated
+// from the default memory resource of the workers.
+std::vector<json_load_result> json_load_files(const std::vector<std::string>& paths, parse_mode mode, const json_load_options& options = {});
+
+#endif //JSON_LOADER_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,59 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_MEMORY_H_INCLUDED
+#define JSON_MEMORY_H_INCLUDED
+
+#include "core.h"
+#include <memory_resource>
+
+//////////////////////////////////////////////////////////////////////////
+//	memory resources
+//////////////////////////////////////////////////////////////////////////
+
+// every node, string buffer and container of a json tree is allocated from
+// the memory resource of the thread that creates it, which defaults to
+// std::pmr::get_default_resource(). a node keeps its resource and gives its
+// memory back to it, whichever thread releases the node last. built with
+// JSON_ENABLE_STATS, the resource returned forwards to that one and counts
+// what it hands out, see json_stats.h.
+std::pmr::memory_resource* json_get_resource();
+
+// sets the resource of the calling thread, nullptr restores the default
+void json_set_resource(std::pmr::memory_resource *resource);
+
+//////////////////////////////////////////////////////////////////////////
+//	json_resource_scope
+//////////////////////////////////////////////////////////////////////////
+
+// uses resource for the calling thread while the scope is alive
+struct json_resource_scope
+{
+private:
+	std::pmr::memory_resource *m_previous;
+
+public:
+	json_resource_scope(std::pmr::memory_resource *resource);
+	json_resource_scope(const json_resource_scope&) = delete;
+	~json_resource_scope();
+};
+
+#endif //JSON_MEMORY_H_INCLUDED
\ No newline at end of file
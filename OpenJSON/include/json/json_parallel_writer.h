@@ -0,0 +1,48 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_PARALLEL_WRITER_H_INCLUDED
+#define JSON_PARALLEL_WRITER_H_INCLUDED
+
+#include "json_vars.h"
+
+struct json_write_options
+{
+	size_t threads = 0;				// 0 for one per hardware thread
+	size_t chunk_nodes = 1 << 14;	// nodes written by a worker in one go
+	size_t chunks_ahead = 4;		// chunks per thread written but not output yet
+};
+
+// writes var exactly as operator<< does, on worker threads. containers
+// larger than a chunk are cut between members or elements, each chunk is
+// written into a buffer by a worker and the buffers are output in order
+// by the calling thread. smaller documents are written on the calling
+// thread. the workers are threads of a pool started on first use and kept
+// for the next documents, it grows to the largest number of threads asked
+// for. the stream formatting is the one of stream.
+void json_write_parallel(std::ostream& stream, const json_var& var, const json_write_options& options = {});
+void json_write_parallel(std::ostream& stream, const json_object& obj, const json_write_options& options = {});
+
+// same into a file descriptor, the ready buffers go out in one writev.
+// returns false when writing to fd fails.
+bool json_write_parallel(int fd, const json_var& var, const json_write_options& options = {});
+
+#endif //JSON_PARALLEL_WRITER_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,219 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_PARSER_H_INCLUDED
+#define JSON_PARSER_H_INCLUDED
+
+#include "json_vars.h"
+#include "json_projection.h"
+#include "json_schema.h"
+
+// the containers a parser is in are kept on a stack of its own, deeper
+// documents are rejected. can be changed per parser with max_depth.
+#if !defined(JSON_PARSE_MAX_DEPTH)
+#define JSON_PARSE_MAX_DEPTH (1 << 20)
+#endif
+
+// shortest array of numbers the parser packs, see json_array
+#if !defined(JSON_PACK_MIN)
+#define JSON_PACK_MIN 2
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//	json_token
+//////////////////////////////////////////////////////////////////////////
+
+enum class json_token_type : uint8_t
+{
+	unknown = 0,
+	obj_start,		// {
+	obj_end,		// }
+	array_start,	// [
+	array_end,		// ]
+	comma,			// ,
+	colon,			// :
+	literal_true,
+	literal_false,
+	literal_null,
+	value_number,
+	value_string
+};
+
+// the content of a token lives in the text buffer of the parser,
+// null terminated so numbers can be converted in place
+struct json_token
+{
+	json_token_type type;
+	size_t pos;			// offset of the token in the source
+	size_t offset;		// offset of the content in the text buffer
+	size_t length;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_parse_result
+//////////////////////////////////////////////////////////////////////////
+
+enum class json_parse_error : uint8_t
+{
+	none,
+	unexpected_character,	// a character that cannot start a token
+	invalid_string,			// a control character or a bad escape in a string
+	invalid_number,
+	number_out_of_range,	// past the range of a float, lazy_numbers keeps such numbers as text
+	invalid_literal,		// a word other than true, false or null
+	unexpected_token,		// a token the grammar does not allow there
+	unexpected_end,			// the input stops inside the document
+	too_deep,				// more nested containers than max_depth
+	schema_mismatch,		// the document does not match the schema, see json_parser::schema
+	cannot_read				// the file could not be opened or read
+};
+
+const char* json_parse_error_string(json_parse_error code);
+
+// why and where a parse failed. nothing is computed on success, the line
+// and column are counted in the source the first time they are asked for,
+// it has to be alive and unchanged until then.
+struct json_parse_result
+{
+private:
+	mutable size_t m_line = 0;
+	mutable size_t m_column = 0;
+
+	void locate() const;
+
+public:
+	json_parse_error code = json_parse_error::none;
+	size_t offset = 0;				// first offending byte
+	const char *source = nullptr;	// the parsed text, set on failure
+	size_t length = 0;
+
+	explicit operator bool() const { return code == json_parse_error::none; }
+	const char* message() const { return json_parse_error_string(code); }
+
+	// 1 based, the column counts bytes. 0 when there is no source.
+	inline size_t line() const { locate(); return m_line; }
+	inline size_t column() const { locate(); return m_column; }
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_parser
+//////////////////////////////////////////////////////////////////////////
+
+// a container being parsed, count is the number of members or elements
+// it has so far. with a schema, the node of the schema it is checked
+// against, where its flags of the required members seen start in the
+// parser and the member being parsed.
+struct json_parse_frame
+{
+	json_node *node;
+	size_t count;
+	bool object;
+	int32_t schema;
+	size_t seen;
+	size_t member;
+	const json_var *var;	// nullptr for the root
+};
+
+// a parser keeps its token and text buffers between documents so a long
+// lived instance stops allocating once it has seen its largest input.
+// parse_into also reuses the nodes, containers and strings already in the
+// destination, parsing documents of the same shape over and over into the
+// same tree does not allocate at all.
+class json_parser
+{
+private:
+	std::vector<json_token> m_tokens;
+	std::string m_text;
+	std::string m_key;		// a key that had to be unescaped
+	size_t m_index;
+	std::vector<json_parse_frame> m_stack;
+	std::vector<uint8_t> m_seen;
+	json_parse_result m_result;
+	json_schema_result m_schema_result;
+
+	// keeps the first error of a parse
+	void fail(json_parse_error code, size_t offset);
+	void fail_syntax(const char *str, size_t length);
+
+	bool lexical_analysis(const char *str, size_t length);
+	bool syntax_analysis(json_object& obj);
+
+	inline const json_token& next() { return m_tokens[m_index++]; }
+	inline const char* text(const json_token& tk) const { return m_text.c_str() + tk.offset; }
+
+	void add_token(json_token_type type, size_t pos, size_t offset = 0, size_t length = 0);
+	bool parse_scalar(json_var& var, const json_token& t);
+	bool parse_value(json_var& var);
+	bool parse_container(json_node *node, bool object, int32_t schema_node = json_schema_node::any);
+	bool schema_fail(json_schema_error code, size_t offset, size_t depth);
+	bool schema_close(const json_parse_frame& frame, size_t offset);
+	bool exact_elements(int32_t schema_node) const;
+	bool parse_packed(json_array& arr, int32_t schema_node = json_schema_node::any);
+
+	bool parse_fragment(const char *str, size_t length, json_var& var);
+	bool read_key(const char *&p, const char *end, std::string_view& key);
+	bool project_value(const char *&p, const char *end, const json_projection_node& node, json_var& var, bool& found, size_t depth);
+	bool project_object(const char *&p, const char *end, const json_projection_node& node, json_object& obj, size_t depth);
+	bool project_array(const char *&p, const char *end, const json_projection_node& node, json_array& arr, size_t depth);
+
+public:
+	parse_mode mode;
+	size_t max_depth;	// containers nested in each other, the root counts
+	bool lazy_numbers;	// numbers are kept as their text, see json_number_text
+	bool pack_numbers;	// arrays of numbers are packed, see json_array
+	// documents that do not match it fail to parse with schema_mismatch.
+	// the values are checked as they are read and a container once it is
+	// closed, a document that breaks several rules may be reported for
+	// another one than by json_schema::validate. not used by projections.
+	const json_schema *schema;
+
+	json_parser();
+	json_parser(parse_mode m);
+	json_parser(const json_parser&) = delete;
+
+	// replace the content of the destination with a new tree
+	bool parse(const char *str, json_object& obj);
+	bool parse(const char *str, size_t length, json_object& obj);
+	bool parse(const char *str, json_var& var);
+	bool parse(const char *str, size_t length, json_var& var);
+
+	// same, overwriting the existing tree in place
+	bool parse_into(const char *str, json_object& obj);
+	bool parse_into(const char *str, size_t length, json_object& obj);
+	bool parse_into(const char *str, json_var& var);
+	bool parse_into(const char *str, size_t length, json_var& var);
+
+	// loads only the parts of the document in the projection, the rest is
+	// skipped by the scan of json_validate, so the document is checked as a
+	// whole all the same
+	bool parse(const char *str, json_var& var, const json_projection& projection);
+	bool parse(const char *str, size_t length, json_var& var, const json_projection& projection);
+
+	// why the last parse failed, reset by the next one
+	inline const json_parse_result& result() const { return m_result; }
+	// where and why the last document did not match the schema
+	inline const json_schema_result& schema_result() const { return m_schema_result; }
+
+	// gives the buffers back
+	void clear();
+};
+
+#endif //JSON_PARSER_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,45 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_PATCH_H_INCLUDED
+#define JSON_PATCH_H_INCLUDED
+
+#include "json_vars.h"
+
+enum class json_patch_format : uint8_t
+{
+	json_patch,		// RFC 6902, an array of operations
+	merge_patch		// RFC 7396, an object shaped like the target
+};
+
+// the patch turning a into b. subtrees shared by a and b (copies of each
+// other, see JSON_ENABLE_COW) are known to be equal without being visited,
+// the cached hashes (see json_hash) lead the walk straight to the changes.
+// arrays are compared element by element, a merge patch replaces a changed
+// array as a whole and cannot set a member to null.
+json_var json_diff(const json_var& a, const json_var& b, json_patch_format format = json_patch_format::json_patch);
+
+// applies patch to var in place. a JSON Patch is applied as a whole or not
+// at all, false is returned when one of its operations fails (a missing
+// path, a failed test, a malformed operation).
+bool json_apply_patch(json_var& var, const json_var& patch, json_patch_format format = json_patch_format::json_patch);
+
+#endif //JSON_PATCH_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_PATTERN_H_INCLUDED
+#define JSON_PATTERN_H_INCLUDED
+
+#include "core.h"
+#include <string_view>
+#include <vector>
+
+// instructions a pattern compiles to at most, counted repetitions are
+// expanded so a{1000}{1000} is refused rather than run
+#if !defined(JSON_PATTERN_MAX_PROGRAM)
+#define JSON_PATTERN_MAX_PROGRAM 16384
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//	json_pattern
+//////////////////////////////////////////////////////////////////////////
+
+// an ECMAScript regular expression as JSON Schema recommends them: code
+// points, ., classes with ranges and \d \w \s and their complements,
+// groups, alternatives, the greedy and lazy quantifiers * + ? {n} {n,}
+// {n,m}, ^ $ \b \B and escapes. lookarounds and backreferences are not
+// supported, a pattern using them does not compile. search runs the
+// program on every thread at once over the code points of the UTF-8, in
+// time linear in the string and without recursing, whatever its length.
+class json_pattern
+{
+private:
+	enum class op : uint8_t
+	{
+		code,		// the code point in arg
+		any,		// anything but a line terminator
+		set,		// the class m_sets[arg]
+		split,		// continues at both next and arg
+		jump,		// continues at arg
+		begin,
+		end,
+		word,		// \b
+		not_word,	// \B
+		match
+	};
+
+	// jumps are relative to the instruction so a repeated part is copied as it is
+	struct instruction
+	{
+		op code;
+		int32_t next;	// split
+		int32_t arg;	// split and jump targets, code point or set
+	};
+
+	struct range
+	{
+		uint32_t first;
+		uint32_t last;
+	};
+
+	struct set
+	{
+		std::vector<range> ranges;
+		bool negated = false;
+	};
+
+	std::vector<instruction> m_program;
+	std::vector<set> m_sets;
+
+	class compiler;
+	bool in_set(const set& s, uint32_t cp) const;
+	bool step(std::vector<uint32_t>& threads, std::vector<uint32_t>& marks, std::vector<int32_t>& stack,
+		uint32_t generation, int32_t pc, uint32_t prev, uint32_t next) const;
+
+public:
+	json_pattern() {}
+
+	// false when the pattern is not valid or not supported
+	bool compile(std::string_view pattern);
+	inline bool compiled() const { return !m_program.empty(); }
+
+	// true when the pattern matches somewhere in str
+	bool search(const char *str, size_t length) const;
+};
+
+#endif //JSON_PATTERN_H_INCLUDED
\ No newline at end of file
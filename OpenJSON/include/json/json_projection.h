@@ -0,0 +1,63 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_PROJECTION_H_INCLUDED
+#define JSON_PROJECTION_H_INCLUDED
+
+#include "core.h"
+#include <string_view>
+
+//////////////////////////////////////////////////////////////////////////
+//	json_projection
+//////////////////////////////////////////////////////////////////////////
+
+// one step of a path. a node marked whole is loaded with everything under
+// it, otherwise only its children are. "*" matches every member of an
+// object and every element of an array, a number matches that element.
+struct json_projection_node
+{
+	std::string name;
+	bool whole = false;
+	std::vector<json_projection_node> children;
+
+	const json_projection_node* find(std::string_view key) const;
+	json_projection_node& child(std::string_view key);
+};
+
+// the parts of a document to load, given as JSON Pointers (RFC 6901) such
+// as "/user/name" or "/items/*/id". the root has to be an object, members
+// outside of the projection are skipped without being converted or copied.
+class json_projection
+{
+private:
+	json_projection_node m_root;
+
+public:
+	json_projection() {}
+	json_projection(std::initializer_list<std::string_view> pointers);
+
+	json_projection& add(std::string_view pointer);
+
+	const json_projection_node& root() const { return m_root; }
+	json_projection_node& root() { return m_root; }
+};
+
+#endif //JSON_PROJECTION_H_INCLUDED
\ No newline at end of file
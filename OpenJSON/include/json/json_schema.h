@@ -0,0 +1,174 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_SCHEMA_H_INCLUDED
+#define JSON_SCHEMA_H_INCLUDED
+
+#include "json_vars.h"
+#include "json_pattern.h"
+
+//////////////////////////////////////////////////////////////////////////
+//	json_schema_result
+//////////////////////////////////////////////////////////////////////////
+
+enum class json_schema_error : uint8_t
+{
+	none,
+	not_parsed,				// the document did not parse, see json_parse_result
+	rejected,				// the schema is false
+	type,
+	enumeration,			// enum or const
+	minimum,				// minimum or exclusiveMinimum
+	maximum,				// maximum or exclusiveMaximum
+	multiple_of,
+	min_length,
+	max_length,
+	pattern,
+	min_items,
+	max_items,
+	min_properties,
+	max_properties,
+	required,
+	additional_property		// a member additionalProperties does not allow
+};
+
+const char* json_schema_error_string(json_schema_error code);
+
+// why a document does not match a schema. the path is the JSON Pointer of
+// the value that does not match, of the missing member for required.
+struct json_schema_result
+{
+	json_schema_error code = json_schema_error::none;
+	std::string path;
+	size_t offset = 0;		// of the value in the source when it was checked while parsed
+
+	explicit operator bool() const { return code == json_schema_error::none; }
+	const char* message() const { return json_schema_error_string(code); }
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_schema
+//////////////////////////////////////////////////////////////////////////
+
+// one schema of a compiled program, the schemas under it are other nodes
+// referred to by their index. a member or an element without a schema of
+// its own is not looked at.
+struct json_schema_node
+{
+	static constexpr int32_t any = -1;		// no schema, everything matches
+	static constexpr int32_t none = -2;		// the false schema
+
+	uint8_t types = 0xff;			// bits of the json_type values, see json_schema.cpp
+	uint8_t flags = 0;
+	double minimum = 0;
+	double maximum = 0;
+	double multiple_of = 0;
+	size_t min_length = 0;
+	size_t max_length = SIZE_MAX;
+	size_t min_items = 0;
+	size_t max_items = SIZE_MAX;
+	size_t min_properties = 0;
+	size_t max_properties = SIZE_MAX;
+	uint32_t properties = 0;		// first of the properties, sorted by hash
+	uint32_t property_count = 0;
+	uint32_t required_count = 0;
+	int32_t additional = any;		// members not in properties
+	int32_t items = any;			// elements past the positional ones
+	uint32_t positional = 0;		// first of the positional element schemas
+	uint32_t positional_count = 0;
+	uint32_t enums = 0;				// first of the allowed values
+	uint32_t enum_count = 0;
+	int32_t pattern = -1;
+};
+
+struct json_schema_property
+{
+	uint64_t hash;
+	std::string key;
+	int32_t node;
+	bool required;
+};
+
+// appends an escaped segment to a JSON Pointer
+void json_append_pointer(std::string& path, std::string_view segment);
+
+// a JSON Schema compiled into a flat program: the keywords become fields
+// of the nodes, the keys of properties are hashed and sorted so a member is
+// found with a binary search, the allowed values of enum are hashed. it
+// covers type, enum, const, minimum, maximum, exclusiveMinimum,
+// exclusiveMaximum, multipleOf, minLength, maxLength, pattern, items (a
+// schema or an array of positional schemas), minItems, maxItems,
+// properties, required, additionalProperties, minProperties and
+// maxProperties, and the true and false schemas. patterns are the subset
+// of ECMAScript regular expressions JSON Schema recommends, matched over
+// code points by json_pattern, lengths are counted in code points too.
+// annotations are ignored, a schema with any other keyword, $ref or the
+// combinators for instance, does not compile rather than letting
+// documents through unchecked.
+// numbers are checked with the value they were written as while parsing,
+// and with what the tree holds otherwise, the numbers of the schema keep
+// the precision it was loaded with: load it with lazy_numbers when enum or
+// const hold integers past 2^24.
+// a compiled schema is read-only, it can be used by any number of threads.
+class json_schema
+{
+private:
+	friend class json_parser;
+
+	std::vector<json_schema_node> m_nodes;			// the root is the first one
+	std::vector<json_schema_property> m_properties;
+	std::vector<int32_t> m_positional;
+	std::vector<json_var> m_enums;
+	std::vector<uint64_t> m_enum_hashes;
+	std::vector<json_pattern> m_patterns;
+	std::string m_error;
+
+	int32_t compile_node(const json_var& schema, std::string& path);
+	bool fail(const std::string& path, const char *what);
+
+	// the schema of a member, sets index to its property or to -1
+	int32_t member(int32_t node, std::string_view key, int32_t& index) const;
+	int32_t element(int32_t node, size_t index) const;
+
+	json_schema_error check_type(const json_schema_node& node, const json_var& var) const;
+	json_schema_error check_number(const json_schema_node& node, double n) const;
+	json_schema_error check_value(const json_schema_node& node, const json_var& var) const;
+	json_schema_error check_counts(const json_schema_node& node, bool object, size_t count) const;
+	json_schema_error check_enum(const json_schema_node& node, const json_var& var) const;
+	json_schema_error check_packed(const json_schema_node& node, const json_array& arr, size_t index) const;
+	json_schema_error check(int32_t node, const json_var& var, json_schema_result& result) const;
+
+public:
+	json_schema() {}
+	json_schema(const json_var& schema) { compile(schema); }
+
+	// replaces the program, returns false and keeps the reason in error()
+	// when schema cannot be compiled. the schema itself is not needed after.
+	bool compile(const json_var& schema);
+	inline bool compiled() const { return !m_nodes.empty(); }
+	inline const std::string& error() const { return m_error; }
+
+	// a schema that did not compile matches nothing. json_parser::schema
+	// checks a document while it is parsed instead.
+	json_schema_result validate(const json_var& var) const;
+};
+
+#endif //JSON_SCHEMA_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,120 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_STATS_H_INCLUDED
+#define JSON_STATS_H_INCLUDED
+
+#include "json_types.h"
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////////
+//	json_stats
+//////////////////////////////////////////////////////////////////////////
+
+// counters filled by the parser and the writer when the library is built
+// with JSON_ENABLE_STATS, without it every counter stays at zero and the
+// instrumentation compiles to nothing.
+// the allocations are counted by the memory resource of the trees (see
+// json_memory.h): nodes, strings, packed numbers, keys and the growth of
+// arrays and objects. the working buffers of json_parser, which it keeps
+// from one parse to the next, the write cache and the streams written to
+// are not part of a tree and are left out.
+struct json_stats
+{
+#if defined(JSON_ENABLE_STATS)
+	static constexpr bool enabled = true;
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	size_t bytes = 0;				// bytes read by the parser or written by the writer
+	size_t tokens = 0;
+	size_t nodes[6] = {};			// indexed by json_type
+	size_t allocations = 0;			// from the memory resources of the trees, see below
+	size_t allocated_bytes = 0;
+	size_t depth = 0;				// current nesting, used while counting
+	size_t max_depth = 0;
+	uint64_t lexical_ns = 0;		// time spent in lexical analysis
+	uint64_t syntax_ns = 0;			// time spent in syntax analysis
+	uint64_t write_ns = 0;			// time spent serializing
+
+	inline void node(json_type type) { nodes[(size_t)type]++; }
+	inline void allocate(size_t size) { allocations++; allocated_bytes += size; }
+	inline void enter() { if (++depth > max_depth) max_depth = depth; }
+	inline void leave() { depth--; }
+
+	size_t node_count() const;
+	void reset();
+};
+
+std::ostream& operator<<(std::ostream& stream, const json_stats& stats);
+
+//////////////////////////////////////////////////////////////////////////
+//	json_stats_scope
+//////////////////////////////////////////////////////////////////////////
+
+// everything the calling thread parses, writes or allocates while the
+// scope is alive is added to stats. only the innermost scope counts.
+struct json_stats_scope
+{
+private:
+	json_stats *m_previous;
+
+public:
+	json_stats_scope(json_stats& stats);
+	json_stats_scope(const json_stats_scope&) = delete;
+	~json_stats_scope();
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	instrumentation
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(JSON_ENABLE_STATS)
+	extern thread_local json_stats *g_json_stats;
+	#define JSON_STATS(x) do { if (g_json_stats != nullptr) g_json_stats->x; } while (0)
+#else
+	#define JSON_STATS(x) do { } while (0)
+#endif
+
+// adds the lifetime of the timer to one of the time counters
+struct json_stats_timer
+{
+#if defined(JSON_ENABLE_STATS)
+	uint64_t json_stats::*m_counter;
+	std::chrono::steady_clock::time_point m_start;
+
+	json_stats_timer(uint64_t json_stats::*counter)
+		: m_counter(counter), m_start(std::chrono::steady_clock::now())
+	{
+	}
+
+	~json_stats_timer()
+	{
+		if (g_json_stats != nullptr)
+			g_json_stats->*m_counter += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+	}
+#else
+	json_stats_timer(uint64_t json_stats::*) {}
+#endif
+};
+
+#endif //JSON_STATS_H_INCLUDED
\ No newline at end of file
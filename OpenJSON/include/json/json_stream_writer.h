@@ -0,0 +1,114 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_STREAM_WRITER_H_INCLUDED
+#define JSON_STREAM_WRITER_H_INCLUDED
+
+#include "json_vars.h"
+#include <string_view>
+#include <type_traits>
+
+//////////////////////////////////////////////////////////////////////////
+//	json_stream_writer
+//////////////////////////////////////////////////////////////////////////
+
+// writes compact JSON as the calls come, without building a tree. the
+// output goes to a string, or through a buffer of buffer_size bytes to a
+// stream or a file descriptor; the buffer is flushed when it fills up and
+// when the writer is destroyed. values written at the top level are
+// separated by a newline, which makes NDJSON.
+// with JSON_ENABLE_ASSERT every call is checked against the nesting state
+// (a key outside of an object, a value without its key, an unbalanced end).
+class json_stream_writer
+{
+private:
+	enum : uint8_t { in_object = 1, has_member = 2 };
+
+	std::string m_buffer;
+	std::string *m_out;			// m_buffer, or the string given to the constructor
+	std::ostream *m_stream;
+	int m_fd;
+	size_t m_flush_size;
+	size_t m_roots;				// values written at the top level
+	bool m_failed;
+	std::vector<uint8_t> m_stack;	// one entry per open container
+	bool m_after_key;			// only checked with JSON_ENABLE_ASSERT, kept so the layout does not depend on it
+
+	void separate();
+	void end(bool object);
+	void integer(int64_t v);
+	void unsigned_integer(uint64_t v);
+	void write(const json_var& var);
+
+	inline void done()
+	{
+		if (m_out == &m_buffer && m_buffer.size() >= m_flush_size)
+			flush();
+	}
+
+public:
+	json_stream_writer(std::string& out);
+	json_stream_writer(std::ostream& stream, size_t buffer_size = 64 * 1024);
+	json_stream_writer(int fd, size_t buffer_size = 64 * 1024);
+	json_stream_writer(const json_stream_writer&) = delete;
+	~json_stream_writer();
+
+	json_stream_writer& begin_object();
+	json_stream_writer& end_object();
+	json_stream_writer& begin_array();
+	json_stream_writer& end_array();
+	json_stream_writer& key(std::string_view k);
+
+	json_stream_writer& value(std::string_view v);
+	json_stream_writer& value(const char *v);
+	json_stream_writer& value(double v);
+	json_stream_writer& value(float v);
+	json_stream_writer& value(bool v);
+	json_stream_writer& value(std::nullptr_t);
+	json_stream_writer& value(const json_var& v);
+
+	template<typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+	json_stream_writer& value(T v)
+	{
+		if constexpr (std::is_signed_v<T>)
+			integer((int64_t)v);
+		else
+			unsigned_integer((uint64_t)v);
+		return *this;
+	}
+
+	// key followed by its value
+	template<typename T>
+	json_stream_writer& member(std::string_view k, const T& v)
+	{
+		key(k);
+		return value(v);
+	}
+
+	// hands the buffered output to the stream or the file descriptor
+	bool flush();
+
+	// false once writing to the stream or the file descriptor failed
+	bool good() const { return !m_failed; }
+	size_t depth() const { return m_stack.size(); }
+};
+
+#endif //JSON_STREAM_WRITER_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,174 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_TABLE_H_INCLUDED
+#define JSON_TABLE_H_INCLUDED
+
+#include "json_vars.h"
+#include <optional>
+#include <string_view>
+
+//////////////////////////////////////////////////////////////////////////
+//	json_bitmap
+//////////////////////////////////////////////////////////////////////////
+
+// one bit per row, used for the null masks of the columns and for the rows
+// selected by a filter. the bits past the last row are always clear.
+class json_bitmap
+{
+private:
+	std::vector<uint64_t> m_words;
+	size_t m_size = 0;
+
+public:
+	json_bitmap() {}
+	json_bitmap(size_t size, bool value);
+
+	inline size_t size() const { return m_size; }
+	inline bool test(size_t index) const { return (m_words[index >> 6] >> (index & 63)) & 1; }
+	inline void set(size_t index) { m_words[index >> 6] |= (uint64_t)1 << (index & 63); }
+	inline void clear(size_t index) { m_words[index >> 6] &= ~((uint64_t)1 << (index & 63)); }
+	size_t count() const;
+
+	json_bitmap& operator&=(const json_bitmap& other);
+	json_bitmap& operator|=(const json_bitmap& other);
+
+	inline const uint64_t* words() const { return m_words.data(); }
+	inline uint64_t* words() { return m_words.data(); }
+	inline size_t word_count() const { return m_words.size(); }
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_column
+//////////////////////////////////////////////////////////////////////////
+
+enum class json_column_type : uint8_t
+{
+	null,		// no row has a value
+	number,		// double
+	integer,	// int64_t, every value was a whole number
+	boolean,	// one byte per row
+	string,		// an index into the dictionary per row
+	variant		// values of several types or containers, kept as json_var
+};
+
+enum class json_compare : uint8_t
+{
+	equal,
+	not_equal,
+	less,
+	less_equal,
+	greater,
+	greater_equal
+};
+
+// the values of one member across the rows of a table, in one contiguous
+// array of the column type. rows without the member or with a null keep a
+// zero and have their bit cleared in the validity mask. every kernel skips
+// them and takes an optional selection to restrict the rows it looks at.
+class json_column
+{
+private:
+	friend class json_table;
+
+	std::string m_name;
+	json_column_type m_type = json_column_type::null;
+	size_t m_rows = 0;
+	json_bitmap m_valid;
+	size_t m_nulls = 0;
+
+	std::vector<double> m_numbers;
+	std::vector<int64_t> m_integers;
+	std::vector<uint8_t> m_booleans;
+	std::vector<uint32_t> m_codes;
+	std::vector<std::string> m_dictionary;
+	std::vector<json_var> m_vars;
+
+public:
+	inline const std::string& name() const { return m_name; }
+	inline json_column_type type() const { return m_type; }
+	inline size_t size() const { return m_rows; }
+	inline size_t null_count() const { return m_nulls; }
+	inline bool is_null(size_t row) const { return !m_valid.test(row); }
+	inline const json_bitmap& valid() const { return m_valid; }
+
+	inline const double* numbers() const { return m_numbers.data(); }
+	inline const int64_t* integers() const { return m_integers.data(); }
+	inline const uint8_t* booleans() const { return m_booleans.data(); }
+	inline const uint32_t* codes() const { return m_codes.data(); }
+	inline const std::vector<std::string>& dictionary() const { return m_dictionary; }
+
+	// the value of a row converted back, null for a missing one
+	json_var get(size_t row) const;
+	// number and integer columns
+	double number(size_t row) const;
+	// string columns
+	std::string_view string(size_t row) const;
+
+	// number and integer columns, nothing when no row is counted
+	double sum(const json_bitmap *selection = nullptr) const;
+	std::optional<double> min(const json_bitmap *selection = nullptr) const;
+	std::optional<double> max(const json_bitmap *selection = nullptr) const;
+
+	// clears the bits of selection whose row does not compare to value,
+	// null rows never match. numbers compare against number and integer
+	// columns, strings only support equal and not_equal.
+	void filter(json_compare op, double value, json_bitmap& selection) const;
+	void filter(json_compare op, std::string_view value, json_bitmap& selection) const;
+	void filter(json_compare op, bool value, json_bitmap& selection) const;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_table
+//////////////////////////////////////////////////////////////////////////
+
+// a struct-of-arrays copy of an array of objects of the same shape, with
+// a column per member name found in any of them in the order they first
+// appear. loops over a member of millions of records then read contiguous
+// typed memory instead of searching every object for the key.
+class json_table
+{
+private:
+	std::vector<json_column> m_columns;
+	size_t m_rows = 0;
+
+public:
+	json_table() {}
+
+	// returns false, leaving the table empty, when an element is not an object
+	bool assign(const json_array& arr);
+	bool assign(const json_var& var);
+	void clear();
+
+	inline size_t rows() const { return m_rows; }
+	inline size_t column_count() const { return m_columns.size(); }
+	inline const json_column& column(size_t index) const { return m_columns[index]; }
+	// nullptr when no row has the member
+	const json_column* column(std::string_view name) const;
+
+	// every row selected, to be narrowed by the filters
+	inline json_bitmap select_all() const { return json_bitmap(m_rows, true); }
+
+	// the rows back as an array of objects, without the null members
+	json_var to_array(const json_bitmap *selection = nullptr) const;
+};
+
+#endif //JSON_TABLE_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,51 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_VALIDATE_H_INCLUDED
+#define JSON_VALIDATE_H_INCLUDED
+
+#include "json_parser.h"
+
+// the validator keeps one bit per open container, on the stack up to this
+// depth and in a vector past it
+#if !defined(JSON_VALIDATE_INLINE_DEPTH)
+#define JSON_VALIDATE_INLINE_DEPTH 4096
+#endif
+
+struct json_validate_result
+{
+	bool valid;
+	size_t offset;	// first offending byte, or the length of the input when valid
+
+	explicit operator bool() const { return valid; }
+};
+
+// checks the grammar accepted by the given mode, without building a tree,
+// and allocating only for documents nested deeper than
+// JSON_VALIDATE_INLINE_DEPTH. a document that passes loads with
+// json_doc::load given the same mode and max_depth (see json_parser). the
+// root has to be an object, only whitespace (and comments in permissive
+// mode) may follow it. validate is stricter in two ways: the input has to
+// be well formed UTF-8, which the parser copies without checking, and a
+// null byte is an error where the parser takes it for the end of the input.
+json_validate_result json_validate(const char *buf, size_t length, parse_mode mode, size_t max_depth = JSON_PARSE_MAX_DEPTH);
+
+#endif //JSON_VALIDATE_H_INCLUDED
\ No newline at end of file
@@ -1,171 +1,684 @@
-/*
-
-Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
-
-This file is part of OpenJSON.
-
-OpenJSON is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or
-(at your option) any later version.
-
-OpenJSON is distributed in the hope that it will be useful,
-but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License
-along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
-
-*/
-
-#ifndef JSON_VARS_H_INCLUDED
-#define JSON_VARS_H_INCLUDED
-
-#include "json_types.h"
-
-//////////////////////////////////////////////////////////////////////////
-//	json_string
-//////////////////////////////////////////////////////////////////////////
-
-struct json_string
-{
-private:
-	char *m_string;
-	size_t m_length;
-
-public:
-	json_string();
-	json_string(const char *str);
-	json_string(const std::string& str);
-	json_string(const json_string& str);
-	~json_string();
-
-	inline const char* get() const { return m_string; }
-	inline size_t size() const { return m_length; }
-
-	void operator=(const char *str);
-	void operator=(const std::string& str);
-	void operator=(const json_string& str);
-	bool operator==(const char *str);
-	bool operator==(const std::string& str);
-	bool operator==(const json_string& str);
-	bool operator!=(const char *str);
-	bool operator!=(const std::string& str);
-	bool operator!=(const json_string& str);
-
-	operator std::string() { return std::string(m_string); }
-};
-
-//////////////////////////////////////////////////////////////////////////
-//	json_array
-//////////////////////////////////////////////////////////////////////////
-
-struct json_array
-{
-private:
-	std::vector<json_var> m_data;
-
-public:
-	json_array(const std::initializer_list<json_var>& list);
-
-	void add(const json_var& var);
-	void remove(size_t index);
-	json_var& get(size_t index);
-
-	inline size_t count() const { return m_data.size(); }
-
-	json_var& operator[](size_t index);
-};
-
-//////////////////////////////////////////////////////////////////////////
-//	json_object
-//////////////////////////////////////////////////////////////////////////
-
-struct json_object
-{
-private:
-	std::vector<std::string> m_keys;
-	std::vector<json_var> m_vars;
-
-public:
-	json_object();
-
-	json_var& get(const std::string& key);
-	const std::string& get_key(size_t index);
-
-	inline size_t count() const { return m_keys.size(); }
-
-	json_var& operator[](size_t index);
-	json_var& operator[](const std::string& key);
-};
-
-//////////////////////////////////////////////////////////////////////////
-//	json_var
-//////////////////////////////////////////////////////////////////////////
-
-struct json_var
-{
-	json_var();
-	json_var(const std::nullptr_t& t);
-	json_var(const json_var& var);
-	json_var(const json_object& obj);
-	json_var(const std::initializer_list<json_var>& list);
-	json_var(const json_array& arr);
-	json_var(const char *str);
-	json_var(const std::string& str);
-	json_var(const json_string& str);
-	json_var(const json_boolean boolean);
-	json_var(const json_number number);
-
-	inline bool is_null()		const { return type == json_type::null; }
-	inline bool is_object()		const { return type == json_type::object; }
-	inline bool is_array()		const { return type == json_type::array; }
-	inline bool is_string()		const { return type == json_type::string; }
-	inline bool is_number()		const { return type == json_type::number; }
-	inline bool is_boolean()	const { return type == json_type::boolean; }
-
-	inline json_object&		to_object()		{ JSON_ASSERT(is_object(),	"json_var : not an object"); return *value.object; }
-	inline json_array&		to_array()		{ JSON_ASSERT(is_array(),	"json_var : not an array");	 return *value.array; }
-	inline json_string&		to_string()		{ JSON_ASSERT(is_string(),	"json_var : not a string");  return *value.string; }
-	inline json_boolean		to_boolean()	{ JSON_ASSERT(is_boolean(), "json_var : not a bool");	 return value.boolean; }
-	inline json_number		to_number()		{ JSON_ASSERT(is_number(),	"json_var : not a number");  return value.number; }
-
-	json_var& get(size_t index);
-	json_var& get(const std::string& key);
-	const std::string& get_key(size_t index);
-
-	void operator=(const std::nullptr_t& t);
-	void operator=(const json_var& var);
-	void operator=(const json_object& obj);
-	void operator=(const std::initializer_list<json_var>& list);
-	void operator=(const json_array& arr);
-	void operator=(const char *str);
-	void operator=(const std::string& str);
-	void operator=(const json_string& str);
-	void operator=(json_boolean boolean);
-	void operator=(json_number number);
-
-	operator json_object&();
-	operator json_array&();
-	operator json_string&();
-	operator json_boolean();
-	operator json_number();
-
-	json_var& operator[](size_t index);
-	json_var& operator[](const std::string& key);
-
-	json_type type;
-	json_value value;
-};
-
-//////////////////////////////////////////////////////////////////////////
-//	operators
-//////////////////////////////////////////////////////////////////////////
-
-std::ostream& operator<<(std::ostream& stream, json_string& str);
-std::ostream& operator<<(std::ostream& stream, json_array& arr);
-std::ostream& operator<<(std::ostream& stream, json_object& obj);
-std::ostream& operator<<(std::ostream& stream, json_var& var);
-
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_VARS_H_INCLUDED
+#define JSON_VARS_H_INCLUDED
+
+#include "json_types.h"
+#include "json_memory.h"
+#include <iterator>
+#include <optional>
+#include <span>
+
+//////////////////////////////////////////////////////////////////////////
+//	json_node
+//////////////////////////////////////////////////////////////////////////
+
+// common part of the heap nodes a json_var points to. the reference count
+// lets copies of a json_var share a node until one of them writes to it,
+// a copied node always starts unshared. the node remembers the memory
+// resource it was created with (see json_memory.h) and caches the hash of
+// its subtree (see json_hash) and, when the library is built with
+// JSON_ENABLE_WRITE_CACHE, its serialized form. every non-const access
+// clears both, a node without them is dirty.
+// a non-const access also hands out a reference that may be written
+// through later, after a cache above the node was filled. a node that did
+// is marked lent for good, and a cache over a subtree with a lent node is
+// only trusted until the next write anywhere (see json_epoch_take). a node
+// that handed out raw memory, the spans of a packed array, is never cached
+// over at all.
+struct json_write_cache;
+
+// the subtree a cache was computed over, the worst of its nodes
+enum json_lent : uint8_t
+{
+	json_lent_none,		// no reference was handed out, the cache holds for good
+	json_lent_refs,		// the cache holds until the epoch moves
+	json_lent_memory	// not cached
+};
+
+// the mutation epoch moves on with every write once a cache that depends on
+// it was taken since, so most writes only read a flag
+extern std::atomic<uint64_t> g_json_epoch;
+extern std::atomic<bool> g_json_epoch_taken;
+
+inline void json_epoch_advance()
+{
+	if (g_json_epoch_taken.load(std::memory_order_relaxed))
+	{
+		g_json_epoch_taken.store(false, std::memory_order_relaxed);
+		g_json_epoch.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// taken before a cache is computed, it is trusted while the epoch is the same
+inline uint64_t json_epoch_take()
+{
+	if (!g_json_epoch_taken.load(std::memory_order_relaxed))
+		g_json_epoch_taken.store(true, std::memory_order_relaxed);
+	return g_json_epoch.load(std::memory_order_relaxed);
+}
+
+struct json_node
+{
+private:
+	mutable std::atomic<uint32_t> m_refs;
+	std::atomic<uint8_t> m_lent;			// json_lent, only ever raised
+	std::pmr::memory_resource *m_resource;
+	mutable std::atomic<uint64_t> m_hash;	// 0 until computed
+	mutable std::atomic<uint64_t> m_hash_epoch;	// 0 when it holds for good
+	mutable std::atomic<json_write_cache*> m_write_cache;
+
+	void drop_write_cache();
+
+public:
+	json_node() : m_refs(1), m_lent(json_lent_none), m_resource(json_get_resource()), m_hash(0), m_hash_epoch(0), m_write_cache(nullptr) {}
+	json_node(const json_node&) : m_refs(1), m_lent(json_lent_none), m_resource(json_get_resource()), m_hash(0), m_hash_epoch(0), m_write_cache(nullptr) {}
+	~json_node() { if (m_write_cache.load(std::memory_order_relaxed) != nullptr) drop_write_cache(); }
+	json_node& operator=(const json_node&) { invalidate(); return *this; }
+
+	inline std::pmr::memory_resource* resource() const { return m_resource; }
+
+	inline bool is_shared() const { return m_refs.load(std::memory_order_acquire) > 1; }
+	inline void retain() const { m_refs.fetch_add(1, std::memory_order_relaxed); }
+	// returns true when the last reference is gone
+	inline bool release() const { return m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+	inline json_lent lent() const { return (json_lent)m_lent.load(std::memory_order_relaxed); }
+
+	// 0 when there is no hash or it cannot be trusted anymore, lent tells
+	// how long it holds
+	inline uint64_t cached_hash(json_lent& lent) const
+	{
+		uint64_t _hash = m_hash.load(std::memory_order_relaxed);
+		if (_hash == 0)
+			return 0;
+		uint64_t _epoch = m_hash_epoch.load(std::memory_order_relaxed);
+		if (_epoch != 0 && _epoch != g_json_epoch.load(std::memory_order_relaxed))
+			return 0;
+		lent = _epoch != 0 ? json_lent_refs : json_lent_none;
+		return _hash;
+	}
+	// epoch is the one taken before the subtree was hashed
+	inline void cache_hash(uint64_t hash, json_lent lent, uint64_t epoch) const
+	{
+		if (lent == json_lent_memory)
+			return;
+		m_hash_epoch.store(lent == json_lent_refs ? epoch : 0, std::memory_order_relaxed);
+		m_hash.store(hash, std::memory_order_relaxed);
+	}
+
+	// a write is coming
+	inline void invalidate()
+	{
+		clear_caches();
+		json_epoch_advance();
+	}
+	// a reference to write through, or the memory itself, is handed out
+	inline void lend(json_lent lent = json_lent_refs)
+	{
+		if (m_lent.load(std::memory_order_relaxed) < lent)
+			m_lent.store(lent, std::memory_order_relaxed);
+		invalidate();
+	}
+	// for the parser, which fills the node without handing anything out
+	inline void clear_caches()
+	{
+		if (m_hash.load(std::memory_order_relaxed) != 0)
+			m_hash.store(0, std::memory_order_relaxed);
+		if (m_write_cache.load(std::memory_order_relaxed) != nullptr)
+			drop_write_cache();
+	}
+
+	// writes the bytes kept for this node to out, if there are some that can
+	// still be trusted. the key tells the indentation and stream format they
+	// were written with apart, lent and epoch are as for the hash.
+	bool write_cached(uint64_t key, std::ostream& out, json_lent& lent) const;
+	void cache_write(uint64_t key, const std::string& bytes, json_lent lent, uint64_t epoch) const;
+};
+
+typedef std::pmr::string json_key;
+
+//////////////////////////////////////////////////////////////////////////
+//	json_string
+//////////////////////////////////////////////////////////////////////////
+
+struct json_string : json_node
+{
+private:
+	char *m_string;
+	size_t m_length;
+	size_t m_capacity;	// 0 when m_string is not allocated
+
+public:
+	json_string();
+	json_string(const char *str);
+	json_string(const char *str, size_t length);
+	json_string(const std::string& str);
+	json_string(const json_string& str);
+	~json_string();
+
+	inline const char* get() const { return m_string; }
+	inline size_t size() const { return m_length; }
+
+	// keeps the current buffer when it is large enough
+	void assign(const char *str, size_t length);
+
+	void operator=(const char *str);
+	void operator=(const std::string& str);
+	void operator=(const json_string& str);
+	bool operator==(const char *str) const;
+	bool operator==(const std::string& str) const;
+	bool operator==(const json_string& str) const;
+	bool operator!=(const char *str) const;
+	bool operator!=(const std::string& str) const;
+	bool operator!=(const json_string& str) const;
+
+	operator std::string() const { return std::string(m_string, m_length); }
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_number_text
+//////////////////////////////////////////////////////////////////////////
+
+// a number as it was written in the source, what a parser with
+// lazy_numbers set gives instead of converting it. the conversions are done
+// the first time they are asked for and kept, from any thread. writers
+// output the text as it is, so the exact digits go through untouched.
+// a number is never handed out for writing and has nothing to cache, so
+// unlike the containers and the strings it is not a json_node: it keeps a
+// reference count, its resource and the text of all but the longest
+// numbers, in 56 bytes.
+struct json_number_text
+{
+private:
+	static constexpr size_t small_size = 23;
+
+	mutable std::atomic<uint32_t> m_refs;
+	uint32_t m_length;
+	std::pmr::memory_resource *m_resource;
+	mutable std::atomic<double> m_double;
+	mutable std::atomic<float> m_number;
+	mutable std::atomic<uint8_t> m_converted;
+	bool m_large;
+	union
+	{
+		char m_small[small_size + 1];
+		struct
+		{
+			char *text;
+			size_t capacity;
+		} m_heap;
+	};
+
+	inline char* data() { return m_large ? m_heap.text : m_small; }
+	inline const char* data() const { return m_large ? m_heap.text : m_small; }
+
+public:
+	json_number_text(const char *text, size_t length);
+	json_number_text(const json_number_text& number);
+	~json_number_text();
+
+	// keeps the current buffer when it is large enough
+	void assign(const char *text, size_t length);
+
+	inline std::string_view text() const { return std::string_view(data(), m_length); }
+
+	// the same as json_node
+	inline std::pmr::memory_resource* resource() const { return m_resource; }
+	inline bool is_shared() const { return m_refs.load(std::memory_order_acquire) > 1; }
+	inline void retain() const { m_refs.fetch_add(1, std::memory_order_relaxed); }
+	inline bool release() const { return m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+	json_number to_number() const;
+	double to_double() const;
+	// the integer part of numbers with a fraction or an exponent, the
+	// numbers out of the range of int64_t saturate
+	int64_t to_integer() const;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_array
+//////////////////////////////////////////////////////////////////////////
+
+// how the numbers of a packed array are stored
+enum class json_packed_type : uint8_t
+{
+	none,		// not packed, the elements are json_vars
+	float32,
+	float64,
+	int64
+};
+
+// the numbers of a packed array, allocated in one block from the array's
+// resource, they follow the header
+struct json_packed
+{
+	json_packed_type type;
+	std::atomic<bool> viewed;	// the elements are also there as json_vars
+	size_t count;
+	size_t capacity;
+
+	inline void* data() { return this + 1; }
+	inline const void* data() const { return this + 1; }
+};
+
+// an array of numbers only can be packed, its numbers are then stored next
+// to each other as floats, doubles or int64_t instead of as json_vars. the
+// parser packs the arrays of numbers it reads as floats, the values they
+// would hold as json_vars, unless it is told not to, see
+// json_parser::pack_numbers. writers, json_hash and == read them packed.
+// floats(), doubles() and integers() hand the numbers out as they are, for
+// loops the compiler can vectorize. the elements can still be reached as
+// json_vars: a const access makes them once, next to the packed numbers,
+// from any thread, and a non-const access unpacks the array for good.
+// int64_t and double elements become lazy numbers (see json_number_text)
+// so they keep their precision.
+struct json_array : json_node
+{
+private:
+	friend class json_parser;
+	mutable std::pmr::vector<json_var> m_data;
+	json_packed *m_packed;
+
+	void view() const;
+	void drop_view();
+	json_packed* allocate_packed(json_packed_type type, size_t count);
+	void free_packed();
+
+public:
+	json_array();
+	json_array(const std::initializer_list<json_var>& list);
+	json_array(std::span<const float> numbers);
+	json_array(std::span<const double> numbers);
+	json_array(std::span<const int64_t> numbers);
+	json_array(const json_array& arr);
+	~json_array();
+	json_array& operator=(const json_array& arr);
+
+	typedef std::pmr::vector<json_var>::iterator iterator;
+	typedef std::pmr::vector<json_var>::const_iterator const_iterator;
+
+	void add(const json_var& var);
+	void insert(size_t index, const json_var& var);
+	void remove(size_t index);
+	json_var& get(size_t index);
+	const json_var& get(size_t index) const;
+
+	inline size_t count() const { return m_packed != nullptr ? m_packed->count : m_data.size(); }
+
+	// like every non-const access, iterating a non-const array clears its caches
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	json_var& operator[](size_t index);
+	const json_var& operator[](size_t index) const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// packed numbers
+
+	inline bool is_packed() const { return m_packed != nullptr; }
+	inline json_packed_type packed_type() const { return m_packed != nullptr ? m_packed->type : json_packed_type::none; }
+
+	// the packed numbers, empty unless the array is packed with that type
+	std::span<const float> floats() const;
+	std::span<const double> doubles() const;
+	std::span<const int64_t> integers() const;
+	// the same for writing, the array keeps its type and count
+	std::span<float> floats();
+	std::span<double> doubles();
+	std::span<int64_t> integers();
+
+	// the element at index as a double, packed or not, it has to be a number
+	double to_double(size_t index) const;
+
+	// the sum, smallest and largest of the numbers, packed or not. the packed
+	// ones go through the kernels of json_table, the elements of an array
+	// that is not packed have to be numbers. min and max are nothing when
+	// the array is empty.
+	double sum() const;
+	std::optional<double> min() const;
+	std::optional<double> max() const;
+
+	// packs an array of numbers only, as int64_t when they are all lazy
+	// integers, as doubles when some are lazy and as floats otherwise.
+	// returns false, and leaves the array as it is, when it is empty or
+	// holds anything else.
+	bool pack();
+	// makes the elements json_vars again
+	void unpack();
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_object
+//////////////////////////////////////////////////////////////////////////
+
+// a member of an object as its iterator hands it out, it refers to the key
+// and the value in place and can be taken apart with a structured binding:
+// for (const auto& [key, value] : obj)
+template <typename V>
+struct json_member
+{
+	const json_key& key;
+	V& value;
+};
+
+template <typename V>
+class json_member_iterator
+{
+private:
+	const json_key *m_key;
+	V *m_var;
+
+public:
+	typedef std::input_iterator_tag iterator_category;
+	typedef std::ptrdiff_t difference_type;
+	typedef json_member<V> value_type;
+	typedef json_member<V> reference;
+	typedef void pointer;
+
+	json_member_iterator() : m_key(nullptr), m_var(nullptr) {}
+	json_member_iterator(const json_key *key, V *var) : m_key(key), m_var(var) {}
+
+	inline reference operator*() const { return { *m_key, *m_var }; }
+	inline json_member_iterator& operator++() { ++m_key; ++m_var; return *this; }
+	inline json_member_iterator operator++(int) { json_member_iterator _it = *this; ++*this; return _it; }
+	inline bool operator==(const json_member_iterator& it) const { return m_var == it.m_var; }
+	inline bool operator!=(const json_member_iterator& it) const { return m_var != it.m_var; }
+
+	inline const json_key& key() const { return *m_key; }
+	inline V& value() const { return *m_var; }
+};
+
+struct json_object : json_node
+{
+private:
+	friend class json_parser;
+	std::pmr::vector<json_key> m_keys;
+	std::pmr::vector<json_var> m_vars;
+
+public:
+	json_object();
+	json_object(const json_object& obj);
+	json_object& operator=(const json_object& obj) = default;
+
+	typedef json_member_iterator<json_var> iterator;
+	typedef json_member_iterator<const json_var> const_iterator;
+
+	json_var& get(std::string_view key);
+	const json_var& get(std::string_view key) const;
+	const json_key& get_key(size_t index) const;
+	bool has(std::string_view key) const;
+	// returns false when there is no such key
+	bool remove(std::string_view key);
+
+	inline size_t count() const { return m_keys.size(); }
+
+	// the members in order, see json_member
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	json_var& operator[](size_t index);
+	json_var& operator[](std::string_view key);
+	const json_var& operator[](size_t index) const;
+	const json_var& operator[](std::string_view key) const;
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_var
+//////////////////////////////////////////////////////////////////////////
+
+struct json_var
+{
+	json_var();
+	json_var(const std::nullptr_t& t);
+	json_var(const json_var& var);
+	json_var(const json_object& obj);
+	json_var(const std::initializer_list<json_var>& list);
+	json_var(const json_array& arr);
+	json_var(const char *str);
+	json_var(const std::string& str);
+	json_var(std::string_view str);
+	json_var(const json_string& str);
+	json_var(const json_boolean boolean);
+	json_var(const json_number number);
+	json_var(const json_number_text& number);
+	json_var(json_var&& var) noexcept;
+	~json_var();
+
+	inline bool is_null()		const { return type == json_type::null; }
+	inline bool is_object()		const { return type == json_type::object; }
+	inline bool is_array()		const { return type == json_type::array; }
+	inline bool is_string()		const { return type == json_type::string; }
+	inline bool is_number()		const { return type == json_type::number; }
+	inline bool is_boolean()	const { return type == json_type::boolean; }
+
+	inline json_object&		to_object()		{ JSON_ASSERT(is_object(),	"json_var : not an object"); detach(); value.object->lend(); return *value.object; }
+	inline json_array&		to_array()		{ JSON_ASSERT(is_array(),	"json_var : not an array");	 detach(); value.array->lend(); return *value.array; }
+	inline json_string&		to_string()		{ JSON_ASSERT(is_string(),	"json_var : not a string");  detach(); value.string->lend(); return *value.string; }
+	inline json_boolean		to_boolean()	const { JSON_ASSERT(is_boolean(), "json_var : not a bool");	 return value.boolean; }
+	inline json_number		to_number()		const { JSON_ASSERT(is_number(),	"json_var : not a number");  return lazy ? value.text->to_number() : value.number; }
+
+	inline const json_object&	to_object()		const { JSON_ASSERT(is_object(),	"json_var : not an object"); return *value.object; }
+	inline const json_array&	to_array()		const { JSON_ASSERT(is_array(),		"json_var : not an array");	 return *value.array; }
+	inline const json_string&	to_string()		const { JSON_ASSERT(is_string(),	"json_var : not a string");  return *value.string; }
+
+	// a number with the precision of a double, lazy numbers keep it
+	double to_double() const;
+	int64_t to_integer() const;
+	// the source text of a lazy number, empty for the others
+	std::string_view number_text() const;
+
+	json_var& get(size_t index);
+	json_var& get(std::string_view key);
+	const json_var& get(size_t index) const;
+	const json_var& get(std::string_view key) const;
+	const json_key& get_key(size_t index) const;
+
+	void operator=(const std::nullptr_t& t);
+	void operator=(const json_var& var);
+	void operator=(const json_object& obj);
+	void operator=(const std::initializer_list<json_var>& list);
+	void operator=(const json_array& arr);
+	void operator=(const char *str);
+	void operator=(const std::string& str);
+	void operator=(std::string_view str);
+	void operator=(const json_string& str);
+	void operator=(json_boolean boolean);
+	void operator=(json_number number);
+	void operator=(const json_number_text& number);
+	void operator=(json_var&& var) noexcept;
+
+	operator json_object&();
+	operator json_array&();
+	operator json_string&();
+	operator json_boolean();
+	operator json_number();
+
+	json_var& operator[](size_t index);
+	json_var& operator[](std::string_view key);
+	const json_var& operator[](size_t index) const;
+	const json_var& operator[](std::string_view key) const;
+
+	// string literals would otherwise be ambiguous with the built-in subscript
+	template <size_t N> inline json_var& operator[](const char (&key)[N]) { return operator[](std::string_view(key)); }
+	template <size_t N> inline const json_var& operator[](const char (&key)[N]) const { return operator[](std::string_view(key)); }
+
+	// a shared node is cloned (one level deep) before it is handed out for
+	// writing. the node of a container or a string, a lazy number has none.
+	inline void detach() { const json_node *_n = node(); if (_n != nullptr && _n->is_shared()) clone_node(); }
+	const json_node* node() const;
+
+	json_type type;
+	bool lazy = false;		// a number held as value.text
+	json_value value;
+
+private:
+	void clone_node();
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	access by position
+//////////////////////////////////////////////////////////////////////////
+
+// defined here, once json_var is complete, so a loop over a container
+// compiles down to a walk over its vectors. the assertions are gone unless
+// the library is built with JSON_ENABLE_ASSERT, which premake only defines
+// in the Debug configuration.
+
+inline json_var& json_array::operator[](size_t index)
+{
+	lend();
+	if (m_packed != nullptr)
+		unpack();
+	JSON_ASSERT(index < count(), "json_array : index out of range");
+	return m_data[index];
+}
+
+inline const json_var& json_array::operator[](size_t index) const
+{
+	if (m_packed != nullptr)
+		view();
+	JSON_ASSERT(index < count(), "json_array : index out of range");
+	return m_data[index];
+}
+
+inline json_var& json_array::get(size_t index) { return operator[](index); }
+inline const json_var& json_array::get(size_t index) const { return operator[](index); }
+
+// like every non-const access, iterating a non-const container clears its caches
+inline json_array::iterator json_array::begin() { lend(); if (m_packed != nullptr) unpack(); return m_data.begin(); }
+inline json_array::iterator json_array::end() { lend(); if (m_packed != nullptr) unpack(); return m_data.end(); }
+inline json_array::const_iterator json_array::begin() const { if (m_packed != nullptr) view(); return m_data.cbegin(); }
+inline json_array::const_iterator json_array::end() const { if (m_packed != nullptr) view(); return m_data.cend(); }
+
+inline json_var& json_object::operator[](size_t index)
+{
+	lend();
+	JSON_ASSERT(index < count(), "json_object : index out of range");
+	return m_vars[index];
+}
+
+inline const json_var& json_object::operator[](size_t index) const
+{
+	JSON_ASSERT(index < count(), "json_object : index out of range");
+	return m_vars[index];
+}
+
+inline const json_key& json_object::get_key(size_t index) const
+{
+	JSON_ASSERT(index < count(), "json_object : index out of range");
+	return m_keys[index];
+}
+
+inline json_object::iterator json_object::begin() { lend(); return iterator(m_keys.data(), m_vars.data()); }
+inline json_object::iterator json_object::end() { lend(); return iterator(m_keys.data() + m_keys.size(), m_vars.data() + m_vars.size()); }
+inline json_object::const_iterator json_object::begin() const { return const_iterator(m_keys.data(), m_vars.data()); }
+inline json_object::const_iterator json_object::end() const { return const_iterator(m_keys.data() + m_keys.size(), m_vars.data() + m_vars.size()); }
+
+//////////////////////////////////////////////////////////////////////////
+//	visiting
+//////////////////////////////////////////////////////////////////////////
+
+// calls the overload of f that takes the value of var: json_object&,
+// json_array&, json_string&, json_number, json_boolean or std::nullptr_t.
+// the switch is on json_type, the overloads are picked at compile time.
+// json_visit(var, json_overloaded{
+//	[](const json_object& obj) { ... },
+//	[](json_number n) { ... },
+//	[](const auto&) { ... } });
+template <typename... F>
+struct json_overloaded : F...
+{
+	using F::operator()...;
+};
+
+template <typename... F>
+json_overloaded(F...) -> json_overloaded<F...>;
+
+template <typename F>
+decltype(auto) json_visit(json_var& var, F&& f)
+{
+	switch (var.type)
+	{
+	case json_type::object:		return f(var.to_object());
+	case json_type::array:		return f(var.to_array());
+	case json_type::string:		return f(var.to_string());
+	case json_type::boolean:	return f(var.value.boolean);
+	case json_type::number:		return f(var.to_number());
+	default:					return f(nullptr);
+	}
+}
+
+template <typename F>
+decltype(auto) json_visit(const json_var& var, F&& f)
+{
+	switch (var.type)
+	{
+	case json_type::object:		return f(*static_cast<const json_object*>(var.value.object));
+	case json_type::array:		return f(*static_cast<const json_array*>(var.value.array));
+	case json_type::string:		return f(*static_cast<const json_string*>(var.value.string));
+	case json_type::boolean:	return f(var.value.boolean);
+	case json_type::number:		return f(var.to_number());
+	default:					return f(nullptr);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	hashing and equality
+//////////////////////////////////////////////////////////////////////////
+
+// hash of the content, members of an object in any order hash the same.
+// the hash of a container or a string is cached in its node until the next
+// non-const access to it. when a reference into the subtree was handed out
+// it only holds until the next write anywhere, so writing through a
+// reference kept across a json_hash of the root is seen (see json_node).
+uint64_t json_hash(const json_var& var);
+
+// deep comparison, unequal cached hashes and shared nodes answer right away.
+// numbers compare by the exact value they hold, however they are stored:
+// lazy integers are read from their text and packed ones as they are, so
+// 16777217 and 16777216 differ, but a float holds what it was rounded to
+// and 0.1f is not the lazy number 0.1.
+bool operator==(const json_var& a, const json_var& b);
+
+namespace std
+{
+	template<> struct hash<json_var>
+	{
+		size_t operator()(const json_var& var) const { return (size_t)json_hash(var); }
+	};
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	operators
+//////////////////////////////////////////////////////////////////////////
+
+std::ostream& operator<<(std::ostream& stream, const json_string& str);
+std::ostream& operator<<(std::ostream& stream, const json_array& arr);
+std::ostream& operator<<(std::ostream& stream, const json_object& obj);
+std::ostream& operator<<(std::ostream& stream, const json_var& var);
+
 #endif //JSON_VARS_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,104 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef JSON_WATCH_H_INCLUDED
+#define JSON_WATCH_H_INCLUDED
+
+#include "json_vars.h"
+#include "json_parser.h"
+#include "json_cache.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct json_watch_options
+{
+	// how often the file is checked where inotify is not available
+	std::chrono::milliseconds interval = std::chrono::milliseconds(500);
+	// how long a change has to settle before the file is parsed
+	std::chrono::milliseconds delay = std::chrono::milliseconds(20);
+};
+
+//////////////////////////////////////////////////////////////////////////
+//	json_watched_doc
+//////////////////////////////////////////////////////////////////////////
+
+// a document that follows its file. a thread of its own waits for changes,
+// with inotify on Linux (the directory is watched, so a file replaced by a
+// rename is seen too) and by checking the stamp of the file every interval
+// elsewhere, then parses the new version and publishes it. readers take a
+// snapshot that is never changed under them without taking a lock or
+// waiting for the watcher, a version is freed once it is replaced and its
+// last snapshot is released.
+// a version that does not parse is skipped, the previous one stays
+// published and the error is kept. the file is parsed in json_doc::mode.
+class json_watched_doc
+{
+public:
+	typedef std::shared_ptr<const json_var> handle;
+
+private:
+	std::string m_file;
+	json_watch_options m_options;
+	// the published version is in m_slots[m_index]. a reader counts itself
+	// in on a slot and backs off when the index moved meanwhile, the watcher
+	// only writes a slot nobody is counted in on.
+	handle m_slots[2];
+	std::atomic<uint32_t> m_index;
+	mutable std::atomic<uint32_t> m_readers[2];
+	std::atomic<uint64_t> m_version;
+	json_file_stamp m_stamp;		// of the published version, used by the watcher only
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	json_parse_result m_error;
+	bool m_stop;
+	bool m_check;
+	int m_pipe[2];					// wakes the inotify watcher
+
+	std::thread m_thread;
+
+	void publish(const handle& doc);
+	bool load();
+	void poll();
+	bool watch();
+	void wake();
+
+public:
+	json_watched_doc(const std::string& file, const json_watch_options& options = {});
+	json_watched_doc(const json_watched_doc&) = delete;
+	~json_watched_doc();
+
+	// the current version, nullptr when no version of the file loaded yet
+	handle get() const;
+	// versions published so far
+	inline uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+	// why the last version did not load
+	json_parse_result error() const;
+	// checks the file now, without waiting for a change
+	void reload();
+
+	inline const std::string& file() const { return m_file; }
+};
+
+#endif //JSON_WATCH_H_INCLUDED
\ No newline at end of file
@@ -1,40 +1,56 @@
-/*
-
-Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
-
-This file is part of OpenJSON.
-
-OpenJSON is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or
-(at your option) any later version.
-
-OpenJSON is distributed in the hope that it will be useful,
-but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License
-along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
-
-*/
-
-#ifndef OPENJSON_H_INCLUDED
-#define OPENJSON_H_INCLUDED
-
-//////////////////////////////////////////////////////////////////////////
-//
-//	 ####   #####   ######  #    #           #   ####    ####   #    #
-//	#    #  #    #  #       ##   #           #  #       #    #  ##   #
-//	#    #  #    #  #####   # #  #           #   ####   #    #  # #  #
-//	#    #  #####   #       #  # #           #       #  #    #  #  # #
-//	#    #  #       #       #   ##      #    #  #    #  #    #  #   ##
-//	 ####   #       ######  #    #       ####    ####    ####   #    #
-//
-//////////////////////////////////////////////////////////////////////////
-
-
-#include "json/json_vars.h"
-#include "json/json_doc.h"
-
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef OPENJSON_H_INCLUDED
+#define OPENJSON_H_INCLUDED
+
+//////////////////////////////////////////////////////////////////////////
+//
+//	 ####   #####   ######  #    #           #   ####    ####   #    #
+//	#    #  #    #  #       ##   #           #  #       #    #  ##   #
+//	#    #  #    #  #####   # #  #           #   ####   #    #  # #  #
+//	#    #  #####   #       #  # #           #       #  #    #  #  # #
+//	#    #  #       #       #   ##      #    #  #    #  #    #  #   ##
+//	 ####   #       ######  #    #       ####    ####    ####   #    #
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+#include "json/json_memory.h"
+#include "json/json_vars.h"
+#include "json/json_projection.h"
+#include "json/json_pattern.h"
+#include "json/json_schema.h"
+#include "json/json_parser.h"
+#include "json/json_validate.h"
+#include "json/json_stream_writer.h"
+#include "json/json_parallel_writer.h"
+#include "json/json_loader.h"
+#include "json/json_cache.h"
+#include "json/json_watch.h"
+#include "json/json_patch.h"
+#include "json/json_table.h"
+#include "json/json_filter.h"
+#include "json/json_doc.h"
+#include "json/json_literal.h"
+#include "json/json_stats.h"
+
 #endif //OPENJSON_H_INCLUDED
\ No newline at end of file
@@ -0,0 +1,287 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_cache.h>
+#include <json/json_doc.h>
+#include <future>
+#include <sys/stat.h>
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+bool json_file_stamp_of(const char *file, json_file_stamp& stamp)
+{
+#if defined(JSON_PLATFORM_WIN)
+	struct _stat64 _s;
+	if (_stat64(file, &_s) != 0)
+		return false;
+	stamp.mtime = (int64_t)_s.st_mtime * 1000000000;
+#else
+	struct stat _s;
+	if (stat(file, &_s) != 0)
+		return false;
+#if defined(JSON_PLATFORM_LINUX)
+	stamp.mtime = (int64_t)_s.st_mtim.tv_sec * 1000000000 + _s.st_mtim.tv_nsec;
+#else
+	stamp.mtime = (int64_t)_s.st_mtime * 1000000000;
+#endif
+#endif
+	stamp.size = (uint64_t)_s.st_size;
+	stamp.inode = (uint64_t)_s.st_ino;
+	return true;
+}
+
+// a key or a string buffer longer than the small string optimization
+static inline size_t heap_of(const json_key& key)
+{
+	return key.capacity() > json_key().capacity() ? key.capacity() + 1 : 0;
+}
+
+size_t json_memory_of(const json_var& var)
+{
+	size_t _memory = 0;
+	std::vector<const json_var*> _stack{ &var };
+	while (!_stack.empty())
+	{
+		const json_var& _var = *_stack.back();
+		_stack.pop_back();
+		if (_var.is_object())
+		{
+			const json_object& _obj = _var.to_object();
+			_memory += sizeof(json_object) + _obj.count() * (sizeof(json_key) + sizeof(json_var));
+			for (const auto& [key, value] : _obj)
+			{
+				_memory += heap_of(key);
+				if (value.is_object() || value.is_array() || value.is_string())
+					_stack.push_back(&value);
+			}
+		}
+		else if (_var.is_array())
+		{
+			const json_array& _arr = _var.to_array();
+			if (_arr.is_packed())
+			{
+				const size_t _size = _arr.packed_type() == json_packed_type::float32 ? sizeof(float) : sizeof(double);
+				_memory += sizeof(json_array) + sizeof(json_packed) + _arr.count() * _size;
+				continue;
+			}
+			_memory += sizeof(json_array) + _arr.count() * sizeof(json_var);
+			for (const json_var& v : _arr)
+				if (v.is_object() || v.is_array() || v.is_string())
+					_stack.push_back(&v);
+		}
+		else if (_var.is_string())
+			_memory += sizeof(json_string) + _var.to_string().size() + 1;
+	}
+	return _memory;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_cache
+//////////////////////////////////////////////////////////////////////////
+
+struct json_cache_load
+{
+	json_cache::handle doc;
+	json_parse_result result;
+};
+
+struct json_cache_entry
+{
+	std::string file;
+	json_file_stamp stamp;
+	std::shared_future<json_cache_load> load;	// ready once parsed
+	bool loaded = false;
+	json_cache::handle doc;
+	size_t memory = 0;
+	std::list<json_cache_entry*>::iterator lru;
+};
+
+json_cache::json_cache(size_t budget)
+	: m_budget(budget), m_memory(0), m_hits(0), m_misses(0)
+{
+}
+
+json_cache::~json_cache()
+{
+	clear();
+}
+
+// drops the least recently used documents until the cache fits its budget
+void json_cache::evict(const json_cache_entry *keep)
+{
+	while (m_memory > m_budget && !m_lru.empty() && m_lru.back() != keep)
+		erase(m_lru.back()->file);
+}
+
+void json_cache::erase(const std::string& file)
+{
+	auto _it = m_entries.find(file);
+	if (_it == m_entries.end())
+		return;
+	json_cache_entry& _entry = *_it->second;
+	if (_entry.loaded)
+	{
+		m_memory -= _entry.memory;
+		m_lru.erase(_entry.lru);
+	}
+	m_entries.erase(_it);
+}
+
+json_cache::handle json_cache::get(const std::string& file)
+{
+	json_parse_result _result;
+	return get(file, _result);
+}
+
+json_cache::handle json_cache::get(const std::string& file, json_parse_result& result)
+{
+	json_file_stamp _stamp;
+	if (!json_file_stamp_of(file.c_str(), _stamp))
+	{
+		remove(file);
+		result = json_parse_result();
+		result.code = json_parse_error::cannot_read;
+		return nullptr;
+	}
+
+	std::shared_ptr<json_cache_entry> _entry;
+	std::promise<json_cache_load> _promise;
+	bool _parse = false;
+	{
+		std::lock_guard<std::mutex> _lock(m_mutex);
+		auto _it = m_entries.find(file);
+		if (_it != m_entries.end() && _it->second->stamp == _stamp)
+		{
+			_entry = _it->second;
+			m_hits++;
+			if (_entry->loaded)
+			{
+				m_lru.splice(m_lru.begin(), m_lru, _entry->lru);
+				result = json_parse_result();
+				return _entry->doc;
+			}
+		}
+		else
+		{
+			// an older version is dropped, a parse of it still completes
+			erase(file);
+			_entry = std::make_shared<json_cache_entry>();
+			_entry->file = file;
+			_entry->stamp = _stamp;
+			_entry->load = _promise.get_future().share();
+			m_entries.emplace(file, _entry);
+			m_misses++;
+			_parse = true;
+		}
+	}
+
+	// the file is being parsed by another thread
+	if (!_parse)
+	{
+		const json_cache_load& _load = _entry->load.get();
+		result = _load.result;
+		return _load.doc;
+	}
+
+	json_cache_load _load;
+	std::shared_ptr<json_var> _doc = std::make_shared<json_var>();
+	const bool _success = json_doc::load_file(file.c_str(), *_doc, _load.result);
+	if (_success)
+		_load.doc = _doc;
+	{
+		std::lock_guard<std::mutex> _lock(m_mutex);
+		auto _it = m_entries.find(file);
+		if (_it != m_entries.end() && _it->second == _entry)
+		{
+			if (!_success)
+				m_entries.erase(_it);
+			else
+			{
+				_entry->loaded = true;
+				_entry->doc = _load.doc;
+				_entry->memory = json_memory_of(*_doc);
+				m_memory += _entry->memory;
+				m_lru.push_front(_entry.get());
+				_entry->lru = m_lru.begin();
+				evict(_entry.get());
+				// alone over the budget, it is handed out but not kept
+				if (m_memory > m_budget)
+					erase(file);
+			}
+		}
+	}
+	result = _load.result;
+	_promise.set_value(std::move(_load));
+	return _success ? handle(_doc) : nullptr;
+}
+
+void json_cache::remove(const std::string& file)
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	erase(file);
+}
+
+void json_cache::clear()
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	m_entries.clear();
+	m_lru.clear();
+	m_memory = 0;
+}
+
+void json_cache::set_budget(size_t bytes)
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	m_budget = bytes;
+	evict(nullptr);
+}
+
+size_t json_cache::budget() const
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	return m_budget;
+}
+
+size_t json_cache::memory() const
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	return m_memory;
+}
+
+size_t json_cache::count() const
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	return m_entries.size();
+}
+
+size_t json_cache::hits() const
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	return m_hits;
+}
+
+size_t json_cache::misses() const
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	return m_misses;
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_escape.h>
+
+#if defined(JSON_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(JSON_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+static inline unsigned first_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward(&i, mask);
+	return (unsigned)i;
+#else
+	return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static inline int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+static bool hex4(const char *str, uint32_t& cp)
+{
+	cp = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		int v = hex_value(str[i]);
+		if (v < 0)
+			return false;
+		cp = (cp << 4) | (uint32_t)v;
+	}
+	return true;
+}
+
+static void put_utf8(uint32_t cp, std::string& out)
+{
+	if (cp < 0x80)
+		out += (char)cp;
+	else if (cp < 0x800)
+	{
+		out += (char)(0xc0 | (cp >> 6));
+		out += (char)(0x80 | (cp & 0x3f));
+	}
+	else if (cp < 0x10000)
+	{
+		out += (char)(0xe0 | (cp >> 12));
+		out += (char)(0x80 | ((cp >> 6) & 0x3f));
+		out += (char)(0x80 | (cp & 0x3f));
+	}
+	else
+	{
+		out += (char)(0xf0 | (cp >> 18));
+		out += (char)(0x80 | ((cp >> 12) & 0x3f));
+		out += (char)(0x80 | ((cp >> 6) & 0x3f));
+		out += (char)(0x80 | (cp & 0x3f));
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// kernels
+//////////////////////////////////////////////////////////////////////////
+
+size_t json_plain_length(const char *str, size_t length, char quote)
+{
+	const uint8_t *p = (const uint8_t*)str;
+	const uint8_t *end = p + length;
+#if defined(JSON_SIMD_SSE2)
+	const __m128i _quote = _mm_set1_epi8(quote);
+	const __m128i _backslash = _mm_set1_epi8('\\');
+	// bytes below 0x20 once 0x80 is added become the lowest signed values
+	const __m128i _bias = _mm_set1_epi8((char)0x80);
+	const __m128i _ctrl = _mm_set1_epi8((char)(0x20 ^ 0x80));
+	while (end - p >= 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)p);
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _quote), _mm_cmpeq_epi8(v, _backslash)),
+			_mm_cmplt_epi8(_mm_xor_si128(v, _bias), _ctrl));
+		unsigned mask = (unsigned)_mm_movemask_epi8(m);
+		if (mask != 0)
+			return (size_t)(p - (const uint8_t*)str) + first_bit(mask);
+		p += 16;
+	}
+#elif defined(JSON_SIMD_NEON)
+	const uint8x16_t _quote = vdupq_n_u8((uint8_t)quote);
+	const uint8x16_t _backslash = vdupq_n_u8('\\');
+	const uint8x16_t _space = vdupq_n_u8(0x20);
+	while (end - p >= 16)
+	{
+		uint8x16_t v = vld1q_u8(p);
+		uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, _quote), vceqq_u8(v, _backslash)), vcltq_u8(v, _space));
+		if (vmaxvq_u8(m) != 0)
+			break;
+		p += 16;
+	}
+#endif
+	while (p < end && *p != (uint8_t)quote && *p != '\\' && *p >= 0x20)
+		p++;
+	return (size_t)(p - (const uint8_t*)str);
+}
+
+size_t json_find(const char *str, size_t length, const char *needle, size_t needle_length)
+{
+	if (needle_length == 0)
+		return 0;
+	if (needle_length > length)
+		return length;
+
+	const uint8_t *s = (const uint8_t*)str;
+	const uint8_t _first = (uint8_t)needle[0];
+	const size_t _starts = length - needle_length + 1;	// positions a match can start at
+	size_t i = 0;
+#if defined(JSON_SIMD_SSE2)
+	const __m128i _head = _mm_set1_epi8((char)_first);
+	const __m128i _tail = _mm_set1_epi8(needle[needle_length - 1]);
+	for (; i + 16 <= _starts; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(s + i + needle_length - 1));
+		unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, _head), _mm_cmpeq_epi8(b, _tail)));
+		while (mask != 0)
+		{
+			size_t j = i + first_bit(mask);
+			if (memcmp(s + j, needle, needle_length) == 0)
+				return j;
+			mask &= mask - 1;
+		}
+	}
+#elif defined(JSON_SIMD_NEON)
+	const uint8x16_t _head = vdupq_n_u8(_first);
+	const uint8x16_t _tail = vdupq_n_u8((uint8_t)needle[needle_length - 1]);
+	for (; i + 16 <= _starts; i += 16)
+	{
+		uint8x16_t a = vld1q_u8(s + i);
+		uint8x16_t b = vld1q_u8(s + i + needle_length - 1);
+		if (vmaxvq_u8(vandq_u8(vceqq_u8(a, _head), vceqq_u8(b, _tail))) == 0)
+			continue;
+		for (size_t j = i; j < i + 16; j++)
+			if (s[j] == _first && memcmp(s + j, needle, needle_length) == 0)
+				return j;
+	}
+#endif
+	for (; i < _starts; i++)
+		if (s[i] == _first && memcmp(s + i, needle, needle_length) == 0)
+			return i;
+	return length;
+}
+
+size_t json_unescape_unicode(const char *str, size_t length, std::string& out)
+{
+	uint32_t _cp;
+	if (length < 4 || !hex4(str, _cp))
+		return 0;
+
+	if (_cp >= 0xdc00 && _cp <= 0xdfff)
+		return 0;	// unpaired low surrogate
+
+	if (_cp >= 0xd800 && _cp <= 0xdbff)
+	{
+		uint32_t _low;
+		if (length < 10 || str[4] != '\\' || str[5] != 'u' || !hex4(str + 6, _low) || _low < 0xdc00 || _low > 0xdfff)
+			return 0;	// unpaired high surrogate
+		put_utf8(0x10000 + ((_cp - 0xd800) << 10) + (_low - 0xdc00), out);
+		return 10;
+	}
+
+	put_utf8(_cp, out);
+	return 4;
+}
+
+// put(const char*, size_t) receives the output in pieces
+template<typename F>
+static void escape_string(const char *str, size_t length, F&& put)
+{
+	static const char _hex[] = "0123456789abcdef";
+	put("\"", 1);
+	size_t i = 0;
+	while (i < length)
+	{
+		size_t n = json_plain_length(str + i, length - i);
+		if (n > 0)
+		{
+			put(str + i, n);
+			i += n;
+			if (i == length)
+				break;
+		}
+
+		char c = str[i++];
+		switch (c)
+		{
+		case '\"': put("\\\"", 2); break;
+		case '\\': put("\\\\", 2); break;
+		case '\b': put("\\b", 2); break;
+		case '\f': put("\\f", 2); break;
+		case '\n': put("\\n", 2); break;
+		case '\r': put("\\r", 2); break;
+		case '\t': put("\\t", 2); break;
+		default:
+		{
+			char _u[6] = { '\\', 'u', '0', '0', _hex[(c >> 4) & 0xf], _hex[c & 0xf] };
+			put(_u, 6);
+		}
+		}
+	}
+	put("\"", 1);
+}
+
+void json_write_string(std::ostream& stream, const char *str, size_t length)
+{
+	escape_string(str, length, [&](const char *s, size_t n) { stream.write(s, (std::streamsize)n); });
+}
+
+void json_append_string(std::string& out, const char *str, size_t length)
+{
+	escape_string(str, length, [&](const char *s, size_t n) { out.append(s, n); });
+}
\ No newline at end of file
@@ -0,0 +1,361 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_filter.h>
+#include <json/json_escape.h>
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+// the keys of a JSON Pointer, ~1 stands for / and ~0 for ~
+static std::vector<std::string> split_pointer(std::string_view pointer)
+{
+	std::vector<std::string> _path;
+	size_t i = 0;
+	while (i < pointer.size())
+	{
+		size_t _end = pointer.find('/', i + 1);
+		if (_end == std::string_view::npos)
+			_end = pointer.size();
+
+		std::string& _name = _path.emplace_back();
+		for (size_t j = i + 1; j < _end; j++)
+		{
+			if (pointer[j] == '~' && j + 1 < _end && (pointer[j + 1] == '0' || pointer[j + 1] == '1'))
+				_name += pointer[++j] == '0' ? '~' : '/';
+			else
+				_name += pointer[j];
+		}
+		i = _end;
+	}
+	return _path;
+}
+
+static bool is_index(std::string_view key)
+{
+	if (key.empty())
+		return false;
+	for (char c : key)
+		if (c < '0' || c > '9')
+			return false;
+	return true;
+}
+
+// written the same in any source without escapes
+static bool is_plain(std::string_view str)
+{
+	return json_plain_length(str.data(), str.size()) == str.size();
+}
+
+// a json_number is compared with the bounds rounded the same way, rounding
+// keeps the order so it passes whenever the text it was parsed from does
+static inline bool in_range(json_number n, const json_predicate& predicate)
+{
+	return n >= (json_number)predicate.min && n <= (json_number)predicate.max;
+}
+
+static bool passes(const json_var& var, const json_predicate& predicate)
+{
+	switch (predicate.type)
+	{
+	case json_predicate_type::equal:
+		return var == predicate.value;
+	case json_predicate_type::prefix:
+		return var.is_string() && std::string_view(var.to_string().get(), var.to_string().size()).starts_with(predicate.text);
+	case json_predicate_type::range:
+	{
+		if (!var.is_number())
+			return false;
+		if (!var.lazy)
+			return in_range(var.value.number, predicate);
+		double d = var.to_double();
+		return d >= predicate.min && d <= predicate.max;
+	}
+	case json_predicate_type::exists:
+		return true;
+	}
+	return false;
+}
+
+// packed elements are read where they are
+static bool passes_packed(const json_array& arr, size_t index, const json_predicate& predicate)
+{
+	if (predicate.type == json_predicate_type::exists)
+		return true;
+	if (predicate.type != json_predicate_type::range)
+		return false;
+	if (arr.packed_type() == json_packed_type::float32)
+		return in_range(arr.floats()[index], predicate);
+	double d = arr.to_double(index);
+	return d >= predicate.min && d <= predicate.max;
+}
+
+static bool holds(const json_var& var, const json_predicate& predicate, size_t depth)
+{
+	if (depth == predicate.path.size())
+		return passes(var, predicate);
+
+	const std::string& _key = predicate.path[depth];
+	const bool _any = _key == "*";
+	if (var.is_object())
+	{
+		for (const auto& [key, value] : var.to_object())
+			if ((_any || key == std::string_view(_key)) && holds(value, predicate, depth + 1))
+				return true;
+		return false;
+	}
+
+	if (!var.is_array() || !(_any || is_index(_key)))
+		return false;
+
+	const json_array& _arr = var.to_array();
+	size_t _first = 0;
+	size_t _last = _arr.count();
+	if (!_any)
+	{
+		_first = (size_t)strtoull(_key.c_str(), nullptr, 10);
+		_last = std::min(_first + 1, _last);
+	}
+
+	const bool _packed = _arr.is_packed() && depth + 1 == predicate.path.size();
+	for (size_t i = _first; i < _last; i++)
+		if (_packed ? passes_packed(_arr, i, predicate) : holds(_arr[i], predicate, depth + 1))
+			return true;
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_filter
+//////////////////////////////////////////////////////////////////////////
+
+json_filter& json_filter::add(json_predicate predicate, std::string_view pointer)
+{
+	JSON_ASSERT(pointer.empty() || pointer[0] == '/', "json_filter : a pointer starts with /");
+
+	predicate.path = split_pointer(pointer);
+	for (const std::string& k : predicate.path)
+		if (k != "*" && !is_index(k) && is_plain(k))
+			add_needle(m_needles, "\"" + k + "\"");
+
+	if (predicate.type == json_predicate_type::equal)
+	{
+		const json_var& v = predicate.value;
+		if (v.is_string() && is_plain(std::string_view(v.to_string().get(), v.to_string().size())))
+			add_needle(m_needles, "\"" + std::string(v.to_string().get(), v.to_string().size()) + "\"");
+		else if (v.is_boolean())
+			add_needle(m_literals, v.to_boolean() ? "true" : "false");
+		else if (v.is_null())
+			add_needle(m_literals, "null");
+	}
+	else if (predicate.type == json_predicate_type::prefix && !predicate.text.empty() && is_plain(predicate.text))
+		add_needle(m_needles, "\"" + predicate.text);
+
+	m_projection.add(pointer);
+	m_predicates.push_back(std::move(predicate));
+	return *this;
+}
+
+// the longest needles are the least likely to be found, they go first
+void json_filter::add_needle(std::vector<std::string>& needles, std::string needle)
+{
+	for (const std::string& n : needles)
+		if (n == needle)
+			return;
+	auto _at = std::find_if(needles.begin(), needles.end(), [&](const std::string& n) { return n.size() < needle.size(); });
+	needles.insert(_at, std::move(needle));
+}
+
+json_filter& json_filter::equal(std::string_view pointer, const json_var& value)
+{
+	if (value.is_number())
+		return range(pointer, value.to_double(), value.to_double());
+	json_predicate _p;
+	_p.type = json_predicate_type::equal;
+	_p.value = value;
+	return add(std::move(_p), pointer);
+}
+
+json_filter& json_filter::prefix(std::string_view pointer, std::string_view text)
+{
+	json_predicate _p;
+	_p.type = json_predicate_type::prefix;
+	_p.text = text;
+	return add(std::move(_p), pointer);
+}
+
+json_filter& json_filter::range(std::string_view pointer, double min, double max)
+{
+	json_predicate _p;
+	_p.type = json_predicate_type::range;
+	_p.min = min;
+	_p.max = max;
+	return add(std::move(_p), pointer);
+}
+
+json_filter& json_filter::exists(std::string_view pointer)
+{
+	json_predicate _p;
+	_p.type = json_predicate_type::exists;
+	return add(std::move(_p), pointer);
+}
+
+bool json_filter::prescan(const char *line, size_t length) const
+{
+	for (const std::string& n : m_literals)
+		if (json_find(line, length, n.data(), n.size()) == length)
+			return false;
+
+	if (m_needles.empty() || memchr(line, '\\', length) != nullptr)
+		return true;
+
+	for (const std::string& n : m_needles)
+		if (json_find(line, length, n.data(), n.size()) == length)
+			return false;
+	return true;
+}
+
+bool json_filter::match(const json_var& record) const
+{
+	for (const json_predicate& p : m_predicates)
+		if (!holds(record, p, 0))
+			return false;
+	return true;
+}
+
+bool json_filter::test(const char *line, size_t length, json_parser& parser, json_var& scratch) const
+{
+	// numbers keep the precision of a double for the ranges
+	const bool _lazy = parser.lazy_numbers;
+	parser.lazy_numbers = true;
+	const bool _parsed = parser.parse(line, length, scratch, m_projection);
+	parser.lazy_numbers = _lazy;
+	return _parsed && match(scratch);
+}
+
+bool json_filter::match(const char *line, size_t length, json_parser& parser, json_var& scratch) const
+{
+	if (parser.mode == parse_mode::strict && !prescan(line, length))
+		return false;
+	return test(line, length, parser, scratch);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_filter_reader
+//////////////////////////////////////////////////////////////////////////
+
+json_filter_reader::json_filter_reader(const json_filter& filter, const char *data, size_t length)
+	: m_filter(filter), m_data(data), m_length(length)
+{
+}
+
+json_filter_reader::json_filter_reader(const json_filter& filter, std::string_view data)
+	: json_filter_reader(filter, data.data(), data.size())
+{
+}
+
+json_filter_reader::json_filter_reader(const json_filter& filter, file_tag, const std::string& file)
+	: m_filter(filter), m_file(file, std::ios::binary)
+{
+	m_more = m_file.is_open();
+}
+
+json_filter_reader json_filter_reader::from_file(const json_filter& filter, const std::string& file)
+{
+	return json_filter_reader(filter, file_tag(), file);
+}
+
+bool json_filter_reader::next_line()
+{
+	for (;;)
+	{
+		const char *_start = m_data + m_pos;
+		const size_t _left = m_length - m_pos;
+		const char *_end = _left > 0 ? (const char*)memchr(_start, '\n', _left) : nullptr;
+
+		// the rest of the buffer is the start of a line, more of it is read
+		if (_end == nullptr && m_more)
+		{
+			m_buffer.erase(0, m_pos);
+			const size_t _kept = m_buffer.size();
+			m_buffer.resize(_kept + JSON_FILTER_CHUNK);
+			m_file.read(m_buffer.data() + _kept, JSON_FILTER_CHUNK);
+			m_buffer.resize(_kept + (size_t)m_file.gcount());
+			m_more = (bool)m_file;
+			m_data = m_buffer.data();
+			m_length = m_buffer.size();
+			m_pos = 0;
+			continue;
+		}
+
+		if (_end == nullptr)
+		{
+			if (_left == 0)
+				return false;
+			_end = _start + _left;
+			m_pos = m_length;
+		}
+		else
+			m_pos = (size_t)(_end - m_data) + 1;
+
+		size_t _size = (size_t)(_end - _start);
+		if (_size > 0 && _start[_size - 1] == '\r')
+			_size--;
+		m_line = std::string_view(_start, _size);
+		m_lines++;
+		return true;
+	}
+}
+
+bool json_filter_reader::next(json_var& record)
+{
+	while (next_line())
+	{
+		if (m_line.empty())
+			continue;
+		if (m_parser.mode == parse_mode::strict && !m_filter.prescan(m_line.data(), m_line.size()))
+			continue;
+
+		m_candidates++;
+		if (!m_filter.test(m_line.data(), m_line.size(), m_parser, m_scratch))
+		{
+			if (!m_parser.result())
+				m_errors++;
+			continue;
+		}
+		if (!m_parser.parse(m_line.data(), m_line.size(), record))
+		{
+			m_errors++;
+			continue;
+		}
+		// the record is what the caller gets, it has to match as well
+		if (!m_filter.match(record))
+			continue;
+
+		m_matches++;
+		return true;
+	}
+
+	m_line = std::string_view();
+	return false;
+}
\ No newline at end of file
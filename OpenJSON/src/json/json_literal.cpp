@@ -0,0 +1,83 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_literal.h>
+
+#include <cstdlib>
+
+void json_literal_error(const char *message)
+{
+	JSON_ASSERT(false, message);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	helper functions
+//////////////////////////////////////////////////////////////////////////
+
+static size_t materialize(json_var& var, const json_literal_node *nodes, const char *chars, size_t index)
+{
+	const json_literal_node& _n = nodes[index];
+	size_t _child = index + 1;
+
+	if (_n.type == json_type::object)
+	{
+		var = json_object();
+		json_object& _obj = var.to_object();
+		for (size_t i = 0; i < _n.count; i++)
+		{
+			const json_literal_node& _c = nodes[_child];
+			_child = materialize(_obj[std::string(chars + _c.key, _c.key_length)], nodes, chars, _child);
+		}
+	}
+	else if (_n.type == json_type::array)
+	{
+		var = json_array({});
+		json_array& _arr = var.to_array();
+		for (size_t i = 0; i < _n.count; i++)
+		{
+			_arr.add(json_var());
+			_child = materialize(_arr[_arr.count() - 1], nodes, chars, _child);
+		}
+	}
+	else if (_n.type == json_type::string)
+		var = std::string(chars + _n.string, _n.string_length);
+	else if (_n.type == json_type::number)
+		var = std::strtof(chars + _n.string, nullptr);
+	else if (_n.type == json_type::boolean)
+		var = _n.boolean;
+	else
+		var = nullptr;
+
+	return index + _n.size;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_literal
+//////////////////////////////////////////////////////////////////////////
+
+json_object json_literal_materialize(const json_literal_node *nodes, const char *chars)
+{
+	// the result lives in a static, keep it out of short lived resources
+	json_resource_scope _scope(std::pmr::get_default_resource());
+	json_var _var;
+	materialize(_var, nodes, chars, 0);
+	return _var.to_object();
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_loader.h>
+#include <json/json_parser.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+//////////////////////////////////////////////////////////////////////////
+// json_loader
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	struct json_pending_file
+	{
+		size_t index;
+		size_t reserved;		// bytes taken from the budget
+		std::string content;
+	};
+
+	class json_loader
+	{
+	private:
+		const std::vector<std::string>& m_paths;
+		std::vector<json_load_result>& m_results;
+		parse_mode m_mode;
+		size_t m_budget;
+
+		std::atomic<size_t> m_next;
+		std::mutex m_mutex;
+		std::condition_variable m_space;	// budget released by a parser
+		std::condition_variable m_ready;	// file read, or no reader left
+		std::deque<json_pending_file> m_queue;
+		size_t m_buffered;
+		size_t m_readers;
+
+		void release(size_t bytes)
+		{
+			{
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_buffered -= bytes;
+			}
+			m_space.notify_all();
+		}
+
+	public:
+		json_loader(const std::vector<std::string>& paths, std::vector<json_load_result>& results, parse_mode mode, size_t budget, size_t readers)
+			: m_paths(paths), m_results(results), m_mode(mode), m_budget(budget), m_next(0), m_buffered(0), m_readers(readers)
+		{
+		}
+
+		void read();
+		void parse();
+	};
+}
+
+void json_loader::read()
+{
+	for (;;)
+	{
+		size_t i = m_next++;
+		if (i >= m_paths.size())
+			break;
+
+		std::ifstream s(m_paths[i], std::ios::binary);
+		if (!s.is_open())
+		{
+			m_results[i].error = "cannot open file";
+			continue;
+		}
+		s.seekg(0, std::ios::end);
+		std::streamoff _end = s.tellg();
+		s.seekg(0, std::ios::beg);
+		if (_end < 0)
+		{
+			m_results[i].error = "cannot read file";
+			continue;
+		}
+		size_t _size = (size_t)_end;
+
+		{
+			std::unique_lock<std::mutex> _lock(m_mutex);
+			m_space.wait(_lock, [&]() { return m_buffered == 0 || m_buffered + _size <= m_budget; });
+			m_buffered += _size;
+		}
+
+		json_pending_file _file = { i, _size, std::string() };
+		_file.content.resize(_size);
+		if (!s.read(_file.content.data(), (std::streamsize)_size))
+		{
+			m_results[i].error = "cannot read file";
+			release(_size);
+			continue;
+		}
+
+		{
+			std::lock_guard<std::mutex> _lock(m_mutex);
+			m_queue.push_back(std::move(_file));
+		}
+		m_ready.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> _lock(m_mutex);
+		m_readers--;
+	}
+	m_ready.notify_all();
+}
+
+void json_loader::parse()
+{
+	json_parser _parser(m_mode);
+	for (;;)
+	{
+		json_pending_file _file;
+		{
+			std::unique_lock<std::mutex> _lock(m_mutex);
+			m_ready.wait(_lock, [&]() { return !m_queue.empty() || m_readers == 0; });
+			if (m_queue.empty())
+				return;
+			_file = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		json_load_result& _result = m_results[_file.index];
+		_result.success = _parser.parse(_file.content.c_str(), _file.content.size(), _result.doc);
+		if (!_result.success)
+			_result.error = _parser.result().message();
+
+		size_t _reserved = _file.reserved;
+		std::string().swap(_file.content);
+		release(_reserved);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_load_files
+//////////////////////////////////////////////////////////////////////////
+
+std::vector<json_load_result> json_load_files(const std::vector<std::string>& paths, parse_mode mode, const json_load_options& options)
+{
+	std::vector<json_load_result> _results(paths.size());
+	if (paths.empty())
+		return _results;
+
+	size_t _parsers = options.parse_threads > 0 ? options.parse_threads : std::max(1u, std::thread::hardware_concurrency());
+	_parsers = std::min(_parsers, paths.size());
+	size_t _readers = std::min(std::max<size_t>(options.io_threads, 1), paths.size());
+
+	json_loader _loader(paths, _results, mode, options.max_buffered_bytes, _readers);
+	std::vector<std::thread> _threads;
+	for (size_t i = 0; i < _readers; i++)
+		_threads.emplace_back([&]() { _loader.read(); });
+	for (size_t i = 0; i < _parsers; i++)
+		_threads.emplace_back([&]() { _loader.parse(); });
+	for (std::thread& t : _threads)
+		t.join();
+
+	return _results;
+}
\ No newline at end of file
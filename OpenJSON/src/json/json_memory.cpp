@@ -0,0 +1,121 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_memory.h>
+#include <json/json_stats.h>
+
+#if defined(JSON_ENABLE_STATS)
+#include <mutex>
+#include <unordered_map>
+#endif
+
+static thread_local std::pmr::memory_resource *g_resource = nullptr;
+
+//////////////////////////////////////////////////////////////////////////
+//	json_counting_resource
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(JSON_ENABLE_STATS)
+
+// forwards to upstream and adds what it hands out to the stats of the
+// allocating thread. nodes, the buffers of their containers, keys and
+// strings all come from their resource, so every byte of a tree is seen.
+class json_counting_resource : public std::pmr::memory_resource
+{
+private:
+	std::pmr::memory_resource *m_upstream;
+
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		void *_p = m_upstream->allocate(bytes, alignment);
+		JSON_STATS(allocate(bytes));
+		return _p;
+	}
+
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override
+	{
+		m_upstream->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+public:
+	json_counting_resource(std::pmr::memory_resource *upstream) : m_upstream(upstream) {}
+};
+
+// one per resource ever used, never destroyed : nodes keep their resource
+// and may be released after static destruction
+static json_counting_resource* counting_resource(std::pmr::memory_resource *upstream)
+{
+	static thread_local std::pmr::memory_resource *t_upstream = nullptr;
+	static thread_local json_counting_resource *t_counting = nullptr;
+	if (upstream == t_upstream)
+		return t_counting;
+
+	static std::mutex *_lock = new std::mutex();
+	static auto *_resources = new std::unordered_map<std::pmr::memory_resource*, json_counting_resource*>();
+	std::lock_guard<std::mutex> _guard(*_lock);
+	json_counting_resource *&_r = (*_resources)[upstream];
+	if (_r == nullptr)
+		_r = new json_counting_resource(upstream);
+	t_upstream = upstream;
+	t_counting = _r;
+	return _r;
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//	memory resources
+//////////////////////////////////////////////////////////////////////////
+
+std::pmr::memory_resource* json_get_resource()
+{
+	std::pmr::memory_resource *_r = g_resource != nullptr ? g_resource : std::pmr::get_default_resource();
+#if defined(JSON_ENABLE_STATS)
+	return counting_resource(_r);
+#else
+	return _r;
+#endif
+}
+
+void json_set_resource(std::pmr::memory_resource *resource)
+{
+	g_resource = resource;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_resource_scope
+//////////////////////////////////////////////////////////////////////////
+
+json_resource_scope::json_resource_scope(std::pmr::memory_resource *resource)
+{
+	m_previous = g_resource;
+	g_resource = resource;
+}
+
+json_resource_scope::~json_resource_scope()
+{
+	g_resource = m_previous;
+}
\ No newline at end of file
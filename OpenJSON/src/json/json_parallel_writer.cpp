@@ -0,0 +1,592 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_parallel_writer.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if defined(JSON_PLATFORM_WIN)
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// containers nested deeper are not cut, their chunk is written whole
+#ifndef JSON_WRITE_PARALLEL_DEPTH
+	#define JSON_WRITE_PARALLEL_DEPTH 256
+#endif
+
+// pieces of the writer, in json_vars.cpp
+void json_write_member_open(std::ostream& stream, const json_object& obj, size_t index, int indent);
+void json_write_member_close(std::ostream& stream, const json_object& obj, size_t index, int indent);
+void json_write_members(std::ostream& stream, const json_object& obj, size_t first, size_t last, int indent);
+void json_write_element_open(std::ostream& stream, const json_array& arr, size_t index);
+void json_write_element_close(std::ostream& stream, const json_array& arr, size_t index);
+void json_write_elements(std::ostream& stream, const json_array& arr, size_t first, size_t last);
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+// the nodes of a subtree, counting stops once cap is reached. the open
+// containers are kept on a stack, not on the native stack.
+static size_t weight(const json_node& node, bool object, size_t cap)
+{
+	struct frame
+	{
+		const json_node *node;
+		bool object;
+		size_t index;
+	};
+	std::vector<frame> _stack;
+	_stack.push_back({ &node, object, 0 });
+
+	size_t _weight = 1;
+	while (!_stack.empty() && _weight < cap)
+	{
+		frame& _f = _stack.back();
+		const size_t _count = _f.object ? static_cast<const json_object*>(_f.node)->count() : static_cast<const json_array*>(_f.node)->count();
+		if (_f.index == _count)
+		{
+			_stack.pop_back();
+			continue;
+		}
+		// the numbers of a packed array weigh one each
+		if (!_f.object && static_cast<const json_array*>(_f.node)->is_packed())
+		{
+			_weight += _count - _f.index;
+			_stack.pop_back();
+			continue;
+		}
+		const json_var& _var = _f.object ? (*static_cast<const json_object*>(_f.node))[_f.index] : (*static_cast<const json_array*>(_f.node))[_f.index];
+		_f.index++;
+		_weight++;
+		if (_var.is_object())
+			_stack.push_back({ &_var.to_object(), true, 0 });
+		else if (_var.is_array())
+			_stack.push_back({ &_var.to_array(), false, 0 });
+	}
+	return _weight;
+}
+
+static size_t weight(const json_object& obj, size_t cap)
+{
+	return weight(obj, true, cap);
+}
+
+static size_t weight(const json_array& arr, size_t cap)
+{
+	return weight(arr, false, cap);
+}
+
+static size_t weight(const json_var& var, size_t cap)
+{
+	if (var.is_object())
+		return weight(var.to_object(), cap);
+	if (var.is_array())
+		return weight(var.to_array(), cap);
+	return 1;
+}
+
+// a container that can be opened, an empty array is written "[]" whole
+static inline bool can_cut(const json_var& var)
+{
+	return (var.is_object() && var.to_object().count() > 0) || (var.is_array() && var.to_array().count() > 0);
+}
+
+#if defined(JSON_PLATFORM_WIN)
+static bool write_fd(int fd, const char *data, size_t size)
+{
+	while (size > 0)
+	{
+		int n = _write(fd, data, (unsigned int)std::min<size_t>(size, 1 << 30));
+		if (n <= 0)
+			return false;
+		data += n;
+		size -= (size_t)n;
+	}
+	return true;
+}
+#else
+static bool write_fd(int fd, struct iovec *iov, int count)
+{
+	while (count > 0)
+	{
+		ssize_t n = ::writev(fd, iov, count);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		// skip what went out, a partial write can stop inside a buffer
+		while (count > 0 && (size_t)n >= iov->iov_len)
+		{
+			n -= (ssize_t)iov->iov_len;
+			iov++;
+			count--;
+		}
+		if (count > 0)
+		{
+			iov->iov_base = (char*)iov->iov_base + n;
+			iov->iov_len -= (size_t)n;
+		}
+	}
+	return true;
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// json_write_plan
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// a run of members or elements written by a worker, or text written
+	// while planning when node is nullptr. ready once text holds the bytes.
+	struct json_write_piece
+	{
+		const json_node *node;
+		bool members;
+		size_t first;
+		size_t last;
+		int indent;
+		std::string text;
+		bool ready;
+	};
+
+	// cuts a document into pieces, following the writer. a member or an
+	// element heavier than a chunk is opened and cut in turn, the lighter
+	// ones are grouped into chunks.
+	class json_write_plan
+	{
+	private:
+		std::vector<json_write_piece>& m_pieces;
+		size_t m_chunk;
+		size_t m_depth;
+		std::ostringstream m_text;
+
+		void flush()
+		{
+			std::string _text = m_text.str();
+			if (_text.empty())
+				return;
+			m_pieces.push_back({ nullptr, false, 0, 0, 0, std::move(_text), true });
+			m_text.str(std::string());
+		}
+
+		void chunk(const json_node& node, bool members, size_t first, size_t last, int indent)
+		{
+			if (first == last)
+				return;
+			flush();
+			m_pieces.push_back({ &node, members, first, last, indent, std::string(), false });
+		}
+
+	public:
+		json_write_plan(std::vector<json_write_piece>& pieces, size_t chunk)
+			: m_pieces(pieces), m_chunk(chunk), m_depth(0)
+		{
+		}
+
+		void members(const json_object& obj, int indent);
+		void elements(const json_array& arr);
+		void finish() { flush(); }
+
+		inline std::ostream& text() { return m_text; }
+	};
+}
+
+void json_write_plan::members(const json_object& obj, int indent)
+{
+	size_t _first = 0, _weight = 0;
+	for (size_t i = 0; i < obj.count(); i++)
+	{
+		const json_var& _var = obj[i];
+		const size_t _w = weight(_var, m_chunk);
+		if (_w >= m_chunk && can_cut(_var) && m_depth < JSON_WRITE_PARALLEL_DEPTH)
+		{
+			chunk(obj, true, _first, i, indent);
+			json_write_member_open(m_text, obj, i, indent);
+			m_depth++;
+			if (_var.is_object())
+				members(_var.to_object(), indent + 1);
+			else
+				elements(_var.to_array());
+			m_depth--;
+			json_write_member_close(m_text, obj, i, indent);
+			_first = i + 1;
+			_weight = 0;
+		}
+		else if ((_weight += _w) >= m_chunk)
+		{
+			chunk(obj, true, _first, i + 1, indent);
+			_first = i + 1;
+			_weight = 0;
+		}
+	}
+	chunk(obj, true, _first, obj.count(), indent);
+}
+
+void json_write_plan::elements(const json_array& arr)
+{
+	m_text << "[ ";
+	if (arr.is_packed())
+	{
+		for (size_t i = 0; i < arr.count(); i += m_chunk)
+			chunk(arr, false, i, std::min(i + m_chunk, arr.count()), 0);
+		m_text << " ]";
+		return;
+	}
+	size_t _first = 0, _weight = 0;
+	for (size_t i = 0; i < arr.count(); i++)
+	{
+		const json_var& _var = arr[i];
+		const size_t _w = weight(_var, m_chunk);
+		if (_w >= m_chunk && can_cut(_var) && m_depth < JSON_WRITE_PARALLEL_DEPTH)
+		{
+			chunk(arr, false, _first, i, 0);
+			json_write_element_open(m_text, arr, i);
+			m_depth++;
+			if (_var.is_object())
+				members(_var.to_object(), 1);
+			else
+				elements(_var.to_array());
+			m_depth--;
+			json_write_element_close(m_text, arr, i);
+			_first = i + 1;
+			_weight = 0;
+		}
+		else if ((_weight += _w) >= m_chunk)
+		{
+			chunk(arr, false, _first, i + 1, 0);
+			_first = i + 1;
+			_weight = 0;
+		}
+	}
+	chunk(arr, false, _first, arr.count(), 0);
+	m_text << " ]";
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_write_pool
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// the worker threads are kept from one document to the next, they are
+	// started when a document first needs them and wait for jobs in
+	// between. jobs of documents written at the same time are queued.
+	class json_write_pool
+	{
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::deque<std::function<void()>> m_jobs;
+		std::vector<std::thread> m_threads;
+		bool m_exit;
+
+		void loop()
+		{
+			for (;;)
+			{
+				std::function<void()> _job;
+				{
+					std::unique_lock<std::mutex> _lock(m_mutex);
+					m_wake.wait(_lock, [&]() { return m_exit || !m_jobs.empty(); });
+					if (m_jobs.empty())
+						return;
+					_job = std::move(m_jobs.front());
+					m_jobs.pop_front();
+				}
+				_job();
+			}
+		}
+
+	public:
+		json_write_pool() : m_exit(false) {}
+		~json_write_pool()
+		{
+			{
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				m_exit = true;
+			}
+			m_wake.notify_all();
+			for (std::thread& t : m_threads)
+				t.join();
+		}
+
+		static json_write_pool& get()
+		{
+			static json_write_pool _pool;
+			return _pool;
+		}
+
+		// the jobs of one document
+		struct batch
+		{
+			std::mutex mutex;
+			std::condition_variable done;
+			size_t left = 0;
+
+			void wait()
+			{
+				std::unique_lock<std::mutex> _lock(mutex);
+				done.wait(_lock, [&]() { return left == 0; });
+			}
+		};
+
+		// runs job on count threads of the pool, wait on jobs for them
+		void start(size_t count, const std::function<void()>& job, batch& jobs)
+		{
+			jobs.left = count;
+			{
+				std::lock_guard<std::mutex> _lock(m_mutex);
+				while (m_threads.size() < count)
+					m_threads.emplace_back([this]() { loop(); });
+				for (size_t i = 0; i < count; i++)
+					m_jobs.push_back([job, &jobs]()
+					{
+						job();
+						std::lock_guard<std::mutex> _lock(jobs.mutex);
+						if (--jobs.left == 0)
+							jobs.done.notify_all();
+					});
+			}
+			m_wake.notify_all();
+		}
+	};
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_parallel_writer
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// workers take the pieces in order and write them into their own
+	// buffer, the calling thread outputs every piece that is ready. the
+	// workers stay at most window pieces ahead of the output.
+	class json_parallel_writer
+	{
+	private:
+		std::vector<json_write_piece>& m_pieces;
+		const std::ostream *m_format;
+		size_t m_window;
+
+		std::mutex m_mutex;
+		std::condition_variable m_ready;	// a piece was written
+		std::condition_variable m_space;	// pieces were output
+		size_t m_next;
+		size_t m_output;
+		bool m_stop;
+
+	public:
+		json_parallel_writer(std::vector<json_write_piece>& pieces, const std::ostream *format, size_t window)
+			: m_pieces(pieces), m_format(format), m_window(window), m_next(0), m_output(0), m_stop(false)
+		{
+		}
+
+		void work();
+		// calls out(first, last) with the next run of ready pieces until
+		// all are out, or out fails
+		template <typename O> bool output(O out);
+	};
+}
+
+void json_parallel_writer::work()
+{
+	std::ostringstream _out;
+	if (m_format != nullptr)
+		_out.copyfmt(*m_format);
+
+	for (;;)
+	{
+		size_t i;
+		{
+			std::unique_lock<std::mutex> _lock(m_mutex);
+			m_space.wait(_lock, [&]() { return m_stop || m_next >= m_pieces.size() || m_next < m_output + m_window; });
+			if (m_stop || m_next >= m_pieces.size())
+				return;
+			i = m_next++;
+		}
+
+		json_write_piece& _piece = m_pieces[i];
+		if (_piece.ready)
+			continue;
+		if (_piece.members)
+			json_write_members(_out, *static_cast<const json_object*>(_piece.node), _piece.first, _piece.last, _piece.indent);
+		else
+			json_write_elements(_out, *static_cast<const json_array*>(_piece.node), _piece.first, _piece.last);
+		_piece.text = _out.str();
+		_out.str(std::string());
+
+		{
+			std::lock_guard<std::mutex> _lock(m_mutex);
+			_piece.ready = true;
+		}
+		m_ready.notify_all();
+	}
+}
+
+template <typename O>
+bool json_parallel_writer::output(O out)
+{
+	size_t i = 0;
+	while (i < m_pieces.size())
+	{
+		size_t _last = i;
+		{
+			std::unique_lock<std::mutex> _lock(m_mutex);
+			m_ready.wait(_lock, [&]() { return m_pieces[i].ready; });
+			while (_last < m_pieces.size() && m_pieces[_last].ready)
+				_last++;
+		}
+
+		const bool _ok = out(i, _last);
+		for (size_t k = i; k < _last; k++)
+			std::string().swap(m_pieces[k].text);
+
+		{
+			std::lock_guard<std::mutex> _lock(m_mutex);
+			m_output = _last;
+			m_stop = !_ok;
+		}
+		m_space.notify_all();
+		if (!_ok)
+			return false;
+		i = _last;
+	}
+	return true;
+}
+
+// plans the document, an object or an array, and writes its pieces on the
+// workers. false when it is too small to be cut or there is a single thread.
+template <typename O>
+static bool write_parallel(const json_object *obj, const json_array *arr, const std::ostream *format, const json_write_options& options, bool& result, O out)
+{
+	// asking the system is not free, it reads /sys on linux
+	static const size_t _hardware = std::max(1u, std::thread::hardware_concurrency());
+	const size_t _threads = options.threads > 0 ? options.threads : _hardware;
+	const size_t _chunk = std::max<size_t>(options.chunk_nodes, 1);
+	if (_threads <= 1)
+		return false;
+	if (obj != nullptr ? weight(*obj, _chunk * 2) < _chunk * 2 : arr == nullptr || weight(*arr, _chunk * 2) < _chunk * 2)
+		return false;
+
+	std::vector<json_write_piece> _pieces;
+	json_write_plan _plan(_pieces, _chunk);
+	if (obj != nullptr)
+	{
+		_plan.text() << "{\n";
+		_plan.members(*obj, 1);
+		_plan.text() << "\n}";
+	}
+	else
+		_plan.elements(*arr);
+	_plan.finish();
+
+	json_parallel_writer _writer(_pieces, format, _threads * std::max<size_t>(options.chunks_ahead, 1));
+	json_write_pool::batch _jobs;
+	json_write_pool::get().start(_threads, [&]() { _writer.work(); }, _jobs);
+	result = _writer.output([&](size_t first, size_t last) { return out(_pieces, first, last); });
+	_jobs.wait();
+	return true;
+}
+
+static inline const json_object* root_object(const json_var& var)
+{
+	return var.is_object() ? &var.to_object() : nullptr;
+}
+
+static inline const json_array* root_array(const json_var& var)
+{
+	return var.is_array() ? &var.to_array() : nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_write_parallel
+//////////////////////////////////////////////////////////////////////////
+
+// writes the pieces into a stream
+static auto stream_output(std::ostream& stream)
+{
+	return [&stream](const std::vector<json_write_piece>& pieces, size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			stream.write(pieces[i].text.data(), (std::streamsize)pieces[i].text.size());
+		return stream.good();
+	};
+}
+
+void json_write_parallel(std::ostream& stream, const json_var& var, const json_write_options& options)
+{
+	bool _result = true;
+	if (!write_parallel(root_object(var), root_array(var), &stream, options, _result, stream_output(stream)))
+		stream << var;
+}
+
+void json_write_parallel(std::ostream& stream, const json_object& obj, const json_write_options& options)
+{
+	bool _result = true;
+	if (!write_parallel(&obj, nullptr, &stream, options, _result, stream_output(stream)))
+		stream << obj;
+}
+
+bool json_write_parallel(int fd, const json_var& var, const json_write_options& options)
+{
+	bool _result = true;
+	auto _out = [fd](const std::vector<json_write_piece>& pieces, size_t first, size_t last)
+	{
+#if defined(JSON_PLATFORM_WIN)
+		for (size_t i = first; i < last; i++)
+			if (!write_fd(fd, pieces[i].text.data(), pieces[i].text.size()))
+				return false;
+		return true;
+#else
+		constexpr int _max = 64;
+		struct iovec _iov[_max];
+		while (first < last)
+		{
+			int _count = 0;
+			for (; first < last && _count < _max; first++)
+				if (!pieces[first].text.empty())
+					_iov[_count++] = { (void*)pieces[first].text.data(), pieces[first].text.size() };
+			if (!write_fd(fd, _iov, _count))
+				return false;
+		}
+		return true;
+#endif
+	};
+	if (write_parallel(root_object(var), root_array(var), nullptr, options, _result, _out))
+		return _result;
+
+	// written on this thread, still in one go
+	std::ostringstream _s;
+	_s << var;
+	std::vector<json_write_piece> _piece(1);
+	_piece[0].text = _s.str();
+	return _out(_piece, 0, 1);
+}
\ No newline at end of file
@@ -0,0 +1,1265 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_parser.h>
+#include <json/json_escape.h>
+#include <json/json_stats.h>
+
+#include <cmath>
+
+//////////////////////////////////////////////////////////////////////////
+// lexical analysis
+//////////////////////////////////////////////////////////////////////////
+
+static inline bool is_whitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline bool is_ctrl(char c)
+{
+	return c >= 0x00 && c <= 0x1f;
+}
+
+void json_parser::add_token(json_token_type type, size_t pos, size_t offset, size_t length)
+{
+	m_tokens.push_back({ type, pos, offset, length });
+}
+
+void json_parser::fail(json_parse_error code, size_t offset)
+{
+	if (m_result.code == json_parse_error::none)
+	{
+		m_result.code = code;
+		m_result.offset = offset;
+	}
+}
+
+bool json_parser::lexical_analysis(const char *str, size_t length)
+{
+	m_tokens.clear();
+	m_text.clear();
+	m_result = json_parse_result();
+	char c;
+	size_t i = 0;
+	size_t state = 0;
+	size_t start = 0;	// content of the current token in m_text
+	size_t pos = 0;		// position of the current token in str
+	bool success = true;
+
+	// closes the content of the current token
+	auto emit = [&](json_token_type type)
+	{
+		add_token(type, pos, start, m_text.size() - start);
+		m_text += '\0';
+	};
+
+	// classifies the word in m_text, it does not stay there
+	auto word = [&]()
+	{
+		std::string_view _word(m_text.c_str() + start, m_text.size() - start);
+		if (_word == "true")
+			add_token(json_token_type::literal_true, pos);
+		else if (_word == "false")
+			add_token(json_token_type::literal_false, pos);
+		else if (_word == "null")
+			add_token(json_token_type::literal_null, pos);
+		else
+		{
+			add_token(json_token_type::unknown, pos);
+			fail(json_parse_error::invalid_literal, pos);
+		}
+		m_text.resize(start);
+	};
+
+	while (i < length && (c = str[i++]) != '\0' && success)
+	{
+		switch (state)
+		{
+		case 0:
+			pos = i - 1;
+			start = m_text.size();
+			if (c == '{')
+				add_token(json_token_type::obj_start, pos);
+			else if (c == '}')
+				add_token(json_token_type::obj_end, pos);
+			else if (c == '[')
+				add_token(json_token_type::array_start, pos);
+			else if (c == ']')
+				add_token(json_token_type::array_end, pos);
+			else if (c == ':')
+				add_token(json_token_type::colon, pos);
+			else if (c == ',')
+				add_token(json_token_type::comma, pos);
+			else if (c == '\"')
+				state = 1;
+			else if (c == '-' || isdigit(c))
+			{
+				// the grammar of RFC 8259: no leading zero, digits on both sides of the point
+				m_text += c;
+				state = c == '-' ? 18 : c == '0' ? 19 : 7;
+			}
+			else if (isalpha(c))
+			{
+				m_text += c;
+				state = 11;
+			}
+			else if (mode == parse_mode::permissive && c == '/') // permissive mode
+				state = 12;
+			else if (mode == parse_mode::permissive && c == '\'') // permissive mode
+				state = 16;
+			else if (!is_whitespace(c))
+			{
+				add_token(json_token_type::unknown, pos);
+				fail(json_parse_error::unexpected_character, pos);
+				success = false;
+			}
+			break;
+		case 1:
+			if (c == '\"')
+			{
+				emit(json_token_type::value_string);
+				state = 0;
+			}
+			else if (c == '\\')
+				state = 2;
+			else if (is_ctrl(c))
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_string, i - 1);
+				success = false;
+			}
+			else
+			{
+				// copies the rest of the run in one go
+				size_t n = json_plain_length(str + i, length - i, '\"');
+				m_text += c;
+				m_text.append(str + i, n);
+				i += n;
+			}
+			break;
+		case 2:
+			if (c == '\"')
+			{
+				m_text += '\"';
+				state = 1;
+			}
+			else if (c == '\\')
+			{
+				m_text += '\\';
+				state = 1;
+			}
+			else if (c == '/')
+			{
+				m_text += '/';
+				state = 1;
+			}
+			else if (c == 'b')
+			{
+				m_text += '\b';
+				state = 1;
+			}
+			else if (c == 'f')
+			{
+				m_text += '\f';
+				state = 1;
+			}
+			else if (c == 'n')
+			{
+				m_text += '\n';
+				state = 1;
+			}
+			else if (c == 'r')
+			{
+				m_text += '\r';
+				state = 1;
+			}
+			else if (c == 't')
+			{
+				m_text += '\t';
+				state = 1;
+			}
+			else if (c == 'u')
+			{
+				// the hex digits, and the escape of a low surrogate, are decoded to UTF-8
+				size_t n = json_unescape_unicode(str + i, length - i, m_text);
+				if (n == 0)
+				{
+					add_token(json_token_type::unknown, i - 1);
+					fail(json_parse_error::invalid_string, i - 1);
+				}
+				i += n;
+				state = 1;
+			}
+			else
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_string, i - 1);
+				state = 1;
+			}
+			break;
+		case 7: // integer digits
+			if (isdigit(c))
+				m_text += c;
+			else if (c == '.' || c == 'e' || c == 'E')
+			{
+				m_text += c;
+				state = c == '.' ? 8 : 9;
+			}
+			else
+			{
+				emit(json_token_type::value_number);
+				state = 0;
+				i--;
+			}
+			break;
+		case 8: // after the point, a digit has to follow
+		case 9: // after the e, a sign or a digit
+		case 20: // after the sign of the exponent, a digit
+			if (isdigit(c))
+			{
+				m_text += c;
+				state = state == 8 ? 21 : 10;
+			}
+			else if (state == 9 && (c == '-' || c == '+'))
+			{
+				m_text += c;
+				state = 20;
+			}
+			else
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_number, i - 1);
+				state = 0;
+			}
+			break;
+		case 10: // exponent digits
+			if (isdigit(c))
+				m_text += c;
+			else
+			{
+				emit(json_token_type::value_number);
+				state = 0;
+				i--;
+			}
+			break;
+		case 18: // after a minus, the integer part
+			if (isdigit(c))
+			{
+				m_text += c;
+				state = c == '0' ? 19 : 7;
+			}
+			else
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_number, i - 1);
+				state = 0;
+			}
+			break;
+		case 19: // a leading zero is the whole integer part
+		case 21: // fraction digits
+			if (isdigit(c) && state == 21)
+				m_text += c;
+			else if ((c == '.' && state == 19) || c == 'e' || c == 'E')
+			{
+				m_text += c;
+				state = c == '.' ? 8 : 9;
+			}
+			else if (isdigit(c))
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_number, i - 1);
+				state = 0;
+			}
+			else
+			{
+				emit(json_token_type::value_number);
+				state = 0;
+				i--;
+			}
+			break;
+		case 11:
+			if (!isalpha(c))
+			{
+				word();
+				state = 0;
+				i--;
+			}
+			else
+				m_text += c;
+			break;
+		case 12:
+			if (c == '/')
+				state = 13;
+			else if (c == '*')
+				state = 14;
+			else
+			{
+				fail(json_parse_error::unexpected_character, i - 1);
+				success = false;
+			}
+			break;
+		case 13: //single line comments
+			if (c == '\n' || c == '\r')
+				state = 0;
+			break;
+		case 14: // multiline comments
+			if (c == '*')
+				state = 15;
+			break;
+		case 15:
+			if (c == '/')
+				state = 0;
+			else if (c != '*')
+				state = 14;
+			break;
+		case 16: //single quoted strings
+			if (c == '\'')
+			{
+				emit(json_token_type::value_string);
+				state = 0;
+			}
+			else if (c == '\\')
+				state = 17;
+			else if (is_ctrl(c))
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_string, i - 1);
+				success = false;
+			}
+			else
+			{
+				// copies the rest of the run in one go
+				size_t n = json_plain_length(str + i, length - i, '\'');
+				m_text += c;
+				m_text.append(str + i, n);
+				i += n;
+			}
+			break;
+		case 17:
+			if (c == '\"')
+			{
+				m_text += '\"';
+				state = 16;
+			}
+			else if (c == '\\')
+			{
+				m_text += '\\';
+				state = 16;
+			}
+			else if (c == '/')
+			{
+				m_text += '/';
+				state = 16;
+			}
+			else if (c == 'b')
+			{
+				m_text += '\b';
+				state = 16;
+			}
+			else if (c == 'f')
+			{
+				m_text += '\f';
+				state = 16;
+			}
+			else if (c == 'n')
+			{
+				m_text += '\n';
+				state = 16;
+			}
+			else if (c == 'r')
+			{
+				m_text += '\r';
+				state = 16;
+			}
+			else if (c == 't')
+			{
+				m_text += '\t';
+				state = 16;
+			}
+			else if (c == 'u')
+			{
+				// the hex digits, and the escape of a low surrogate, are decoded to UTF-8
+				size_t n = json_unescape_unicode(str + i, length - i, m_text);
+				if (n == 0)
+				{
+					add_token(json_token_type::unknown, i - 1);
+					fail(json_parse_error::invalid_string, i - 1);
+				}
+				i += n;
+				state = 16;
+			}
+			else
+			{
+				add_token(json_token_type::unknown, i - 1);
+				fail(json_parse_error::invalid_string, i - 1);
+				state = 16;
+			}
+			break;
+		}
+	}
+
+	// a number or a word can end the input when it is a fragment of a document
+	if (success && (state == 7 || state == 10 || state == 19 || state == 21))
+	{
+		emit(json_token_type::value_number);
+		state = 0;
+	}
+	else if (success && state == 11)
+	{
+		word();
+		state = 0;
+	}
+
+	// the syntax analysis stops on this one instead of running off the end
+	add_token(json_token_type::unknown, i);
+	if (success && state != 0 && state != 13)
+	{
+		fail(json_parse_error::unexpected_end, i);
+		success = false;
+	}
+	return success;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// syntax analysis
+//////////////////////////////////////////////////////////////////////////
+
+// destinations are reused when they hold a node of the right type that
+// no other json_var shares, otherwise they get a new one
+bool json_parser::parse_scalar(json_var& var, const json_token& t)
+{
+	switch (t.type)
+	{
+	case json_token_type::value_number:
+		JSON_STATS(node(json_type::number));
+		if (!lazy_numbers)
+		{
+			// JSON has no infinities, a number past the range of a float is refused
+			const json_number _n = std::strtof(text(t), nullptr);
+			if (std::isinf(_n))
+			{
+				fail(json_parse_error::number_out_of_range, t.pos);
+				return false;
+			}
+			var = _n;
+		}
+		else if (var.lazy && !var.value.text->is_shared())
+			var.value.text->assign(text(t), t.length);
+		else
+			var = json_number_text(text(t), t.length);
+		return true;
+	case json_token_type::value_string:
+		JSON_STATS(node(json_type::string));
+		if (var.is_string() && !var.value.string->is_shared())
+			var.value.string->assign(text(t), t.length);
+		else
+			var = std::string_view(text(t), t.length);
+		return true;
+	case json_token_type::literal_true:
+		JSON_STATS(node(json_type::boolean));
+		var = true;
+		return true;
+	case json_token_type::literal_false:
+		JSON_STATS(node(json_type::boolean));
+		var = false;
+		return true;
+	case json_token_type::literal_null:
+		JSON_STATS(node(json_type::null));
+		var = nullptr;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool json_parser::parse_value(json_var& var)
+{
+	const json_token& _t = next();
+	if (_t.type == json_token_type::obj_start)
+	{
+		if (!var.is_object() || var.value.object->is_shared())
+			var = json_object();
+		return parse_container(var.value.object, true);
+	}
+	if (_t.type == json_token_type::array_start)
+	{
+		if (!var.is_array() || var.value.array->is_shared())
+			var = json_array();
+		if (parse_packed(*var.value.array))
+			return true;
+		return parse_container(var.value.array, false);
+	}
+	return parse_scalar(var, _t);
+}
+
+// true when schema_node checks the values of the elements of an array, the
+// numbers are then checked as written one by one, see parse_container,
+// rather than packed as floats
+bool json_parser::exact_elements(int32_t schema_node) const
+{
+	const json_schema_node& _n = schema->m_nodes[schema_node];
+	for (uint32_t i = 0; i <= _n.positional_count; i++)
+	{
+		const int32_t _e = i < _n.positional_count ? schema->m_positional[_n.positional + i] : _n.items;
+		if (_e >= 0 && (schema->m_nodes[_e].enum_count > 0 || schema->m_nodes[_e].flags != 0))
+			return true;
+	}
+	return false;
+}
+
+// an array of numbers only, JSON_PACK_MIN of them or more, is read straight
+// into the packed floats of arr, the values the numbers would hold as
+// json_vars, so packing never changes what is read or written. returns
+// false, with arr ready for parse_container, when the array is anything
+// else, a number is out of range or schema_node checks the numbers as
+// written. the opening token has been read.
+bool json_parser::parse_packed(json_array& arr, int32_t schema_node)
+{
+	size_t _end = m_index;
+	if (pack_numbers && !lazy_numbers && (schema_node < 0 || !exact_elements(schema_node)))
+	{
+		for (;; _end++)
+		{
+			if (m_tokens[_end].type != json_token_type::value_number)
+				break;
+			if (m_tokens[++_end].type != json_token_type::comma)
+				break;
+		}
+	}
+
+	const size_t _count = (_end - m_index + 1) / 2;
+	// a number ends the list, not a comma
+	if (_count < JSON_PACK_MIN || (_end - m_index) % 2 == 0 || m_tokens[_end].type != json_token_type::array_end)
+	{
+		// the elements made by a const access are reused as any others
+		arr.free_packed();
+		return false;
+	}
+
+	arr.clear_caches();
+	json_packed *_packed = arr.allocate_packed(json_packed_type::float32, _count);
+	float *_floats = static_cast<float*>(_packed->data());
+	arr.m_data.clear();
+	for (size_t i = 0; i < _count; i++)
+	{
+		const json_token& _t = m_tokens[m_index + 2 * i];
+		_floats[i] = std::strtof(text(_t), nullptr);
+		// parse_container reports it
+		if (std::isinf(_floats[i]))
+		{
+			arr.free_packed();
+			return false;
+		}
+	}
+	m_index = _end + 1;
+
+	JSON_STATS(node(json_type::array));
+	JSON_STATS(enter());
+	JSON_STATS(nodes[(size_t)json_type::number] += _count);
+	JSON_STATS(leave());
+	return true;
+}
+
+// the containers being parsed are kept on m_stack rather than on the native
+// stack, the depth of a document is only bounded by max_depth. the opening
+// token of node has been read.
+bool json_parser::parse_container(json_node *node, bool object, int32_t schema_node)
+{
+	m_stack.clear();
+	m_seen.clear();
+	m_stack.push_back({ node, 0, object, schema_node, 0, 0, nullptr });
+	if (schema_node >= 0 && object)
+		m_seen.resize(schema->m_nodes[schema_node].property_count, 0);
+	node->clear_caches();
+	JSON_STATS(node(object ? json_type::object : json_type::array));
+	bool _first = true;
+
+	for (;;)
+	{
+		json_parse_frame& _f = m_stack.back();
+		const json_token *_t = &next();
+		const json_token_type _end = _f.object ? json_token_type::obj_end : json_token_type::array_end;
+
+		// a member or an element follows a comma, except the first one
+		bool _close = false;
+		if (_first)
+		{
+			_first = false;
+			if (_t->type == _end)
+				_close = true;
+			else
+				JSON_STATS(enter());
+		}
+		else if (_t->type == json_token_type::comma)
+			_t = &next();
+		else if (_t->type == _end)
+			_close = true;
+		else
+			return false;
+
+		if (_close)
+		{
+			if (_f.schema >= 0 && !schema_close(_f, _t->pos))
+				return false;
+			// what is left from the tree that was there before goes away
+			if (_f.object)
+			{
+				json_object& _obj = *static_cast<json_object*>(_f.node);
+				_obj.m_keys.erase(_obj.m_keys.begin() + _f.count, _obj.m_keys.end());
+				_obj.m_vars.erase(_obj.m_vars.begin() + _f.count, _obj.m_vars.end());
+			}
+			else
+			{
+				json_array& _arr = *static_cast<json_array*>(_f.node);
+				_arr.m_data.erase(_arr.m_data.begin() + _f.count, _arr.m_data.end());
+			}
+			if (_f.count > 0)
+				JSON_STATS(leave());
+			m_stack.pop_back();
+			if (m_stack.empty())
+				return true;
+			continue;
+		}
+
+		json_var *_var;
+		int32_t _schema = json_schema_node::any;
+		if (_f.object)
+		{
+			json_object& _obj = *static_cast<json_object*>(_f.node);
+			if (_t->type != json_token_type::value_string)
+				return false;
+			std::string_view _key(text(*_t), _t->length);
+
+			if (next().type != json_token_type::colon)
+				return false;
+
+			// a repeated key overwrites the first value, like json_object::get
+			size_t i = 0;
+			while (i < _f.count && _obj.m_keys[i] != _key)
+				i++;
+			if (i == _f.count)
+			{
+				if (_f.count < _obj.m_keys.size())
+					_obj.m_keys[_f.count].assign(_key.data(), _key.size());
+				else
+				{
+					_obj.m_keys.emplace_back(_key.data(), _key.size());
+					_obj.m_vars.emplace_back();
+				}
+				_f.count++;
+			}
+			_var = &_obj.m_vars[i];
+			_f.member = i;
+
+			// the schema of the member, it is marked seen when it is required
+			if (_f.schema >= 0)
+			{
+				int32_t _property;
+				_schema = schema->member(_f.schema, _key, _property);
+				if (_property >= 0 && schema->m_properties[_property].required)
+					m_seen[_f.seen + (size_t)_property - schema->m_nodes[_f.schema].properties] = 1;
+				if (_schema == json_schema_node::none && _property < 0)
+					return schema_fail(json_schema_error::additional_property, _t->pos, m_stack.size());
+			}
+			_t = &next();
+		}
+		else
+		{
+			json_array& _arr = *static_cast<json_array*>(_f.node);
+			if (_f.count == _arr.m_data.size())
+				_arr.m_data.emplace_back();
+			_f.member = _f.count;
+			_var = &_arr.m_data[_f.count++];
+			if (_f.schema >= 0)
+				_schema = schema->element(_f.schema, _f.member);
+		}
+		if (_schema == json_schema_node::none)
+			return schema_fail(json_schema_error::rejected, _t->pos, m_stack.size());
+
+		json_node *_child = nullptr;
+		bool _object = false;
+		if (_t->type == json_token_type::obj_start)
+		{
+			if (!_var->is_object() || _var->value.object->is_shared())
+				*_var = json_object();
+			_child = _var->value.object;
+			_object = true;
+		}
+		else if (_t->type == json_token_type::array_start)
+		{
+			if (!_var->is_array() || _var->value.array->is_shared())
+				*_var = json_array();
+			_child = _var->value.array;
+		}
+		else if (!parse_scalar(*_var, *_t))
+			return false;
+		else if (_schema >= 0)
+		{
+			// a number is checked as written, not as the float it was read as,
+			// when its value matters to the schema
+			const json_schema_node& _node = schema->m_nodes[_schema];
+			const json_schema_error _e = _t->type == json_token_type::value_number && !lazy_numbers && (_node.enum_count > 0 || _node.flags != 0)
+				? schema->check_value(_node, json_var(json_number_text(text(*_t), _t->length)))
+				: schema->check_value(_node, *_var);
+			if (_e != json_schema_error::none)
+				return schema_fail(_e, _t->pos, m_stack.size());
+		}
+
+		if (_child != nullptr)
+		{
+			if (m_stack.size() >= max_depth)
+			{
+				m_result.code = json_parse_error::too_deep;
+				m_result.offset = _t->pos;
+				return false;
+			}
+			if (!_object && parse_packed(*static_cast<json_array*>(_child), _schema))
+			{
+				// a packed array is checked whole, from its numbers
+				json_schema_result _result;
+				if (_schema >= 0 && schema->check(_schema, *_var, _result) != json_schema_error::none)
+				{
+					schema_fail(_result.code, _t->pos, m_stack.size());
+					m_schema_result.path += _result.path;
+					return false;
+				}
+				continue;
+			}
+			// _f is not used past this point, the push may move the frames
+			m_stack.push_back({ _child, 0, _object, _schema, m_seen.size(), 0, _var });
+			if (_schema >= 0 && _object)
+				m_seen.resize(m_seen.size() + schema->m_nodes[_schema].property_count, 0);
+			_child->clear_caches();
+			JSON_STATS(node(_object ? json_type::object : json_type::array));
+			_first = true;
+		}
+	}
+}
+
+bool json_parser::syntax_analysis(json_object& obj)
+{
+	m_index = 0;
+	JSON_STATS(depth = 0);
+	if (next().type != json_token_type::obj_start)
+		return false;
+
+	bool _parsed;
+	if (schema == nullptr)
+		_parsed = parse_container(&obj, true);
+	else if (!schema->compiled())
+		return schema_fail(json_schema_error::rejected, m_tokens[0].pos, 0);
+	else
+		_parsed = parse_container(&obj, true, 0);
+
+	// nothing but the end of the input may follow the root
+	if (_parsed && m_index != m_tokens.size() - 1)
+	{
+		next();
+		return false;
+	}
+	return _parsed;
+}
+
+// the path goes through the members or elements being parsed in the first
+// depth frames. returns false, for the parse to stop.
+bool json_parser::schema_fail(json_schema_error code, size_t offset, size_t depth)
+{
+	m_schema_result.code = code;
+	m_schema_result.offset = offset;
+	m_schema_result.path.clear();
+	for (size_t d = 0; d < depth; d++)
+	{
+		const json_parse_frame& _f = m_stack[d];
+		if (_f.object)
+			json_append_pointer(m_schema_result.path, static_cast<const json_object*>(_f.node)->m_keys[_f.member]);
+		else
+			json_append_pointer(m_schema_result.path, std::to_string(_f.member));
+	}
+	m_result.code = json_parse_error::schema_mismatch;
+	m_result.offset = offset;
+	return false;
+}
+
+// what can only be checked once the container is read: its type and
+// counts, the required members and the allowed values. frame is the top
+// of the stack, offset the position of its closing token.
+bool json_parser::schema_close(const json_parse_frame& frame, size_t offset)
+{
+	const json_schema_node& _n = schema->m_nodes[frame.schema];
+	const size_t _depth = m_stack.size() - 1;
+	json_schema_error _e = json_schema_error::none;
+	if (!(_n.types & (1 << (int)(frame.object ? json_type::object : json_type::array))))
+		_e = _n.types == 0 ? json_schema_error::rejected : json_schema_error::type;
+	else
+		_e = schema->check_counts(_n, frame.object, frame.count);
+	if (_e != json_schema_error::none)
+		return schema_fail(_e, offset, _depth);
+
+	if (frame.object && _n.required_count > 0)
+	{
+		for (uint32_t i = 0; i < _n.property_count; i++)
+			if (schema->m_properties[_n.properties + i].required && m_seen[frame.seen + i] == 0)
+			{
+				schema_fail(json_schema_error::required, offset, _depth);
+				json_append_pointer(m_schema_result.path, schema->m_properties[_n.properties + i].key);
+				return false;
+			}
+	}
+	if (frame.object)
+		m_seen.resize(frame.seen);
+
+	// the root is only a json_object, it is looked at through a copy
+	if (_n.enum_count > 0)
+	{
+		const json_var _root = frame.var == nullptr ? json_var(*static_cast<const json_object*>(frame.node)) : json_var();
+		if (schema->check_enum(_n, frame.var != nullptr ? *frame.var : _root) != json_schema_error::none)
+			return schema_fail(json_schema_error::enumeration, offset, _depth);
+	}
+	return true;
+}
+
+// the token the syntax analysis stopped on is the last one it took. an
+// unknown token other than the last one was reported by the lexer already.
+void json_parser::fail_syntax(const char *str, size_t length)
+{
+	m_result.source = str;
+	m_result.length = length;
+	if (m_result.code == json_parse_error::too_deep || m_result.code == json_parse_error::schema_mismatch ||
+		m_result.code == json_parse_error::number_out_of_range)
+		return;
+	const size_t _last = m_tokens.size() - 1;
+	const size_t _index = m_index > 0 ? std::min(m_index - 1, _last) : 0;
+	const json_token& _t = m_tokens[_index];
+	if (_index == _last || _t.type != json_token_type::unknown)
+	{
+		m_result.code = _index == _last ? json_parse_error::unexpected_end : json_parse_error::unexpected_token;
+		m_result.offset = _t.pos;
+	}
+	else
+		fail(json_parse_error::unexpected_token, _t.pos);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// projection
+//////////////////////////////////////////////////////////////////////////
+
+// skips one value without converting or copying anything, in json_validate.cpp
+bool json_validate_skip(const char *&p, const char *end, parse_mode mode, size_t depth, size_t max_depth);
+
+static bool skip_whitespace(const char *&p, const char *end, bool permissive)
+{
+	while (p < end)
+	{
+		if (is_whitespace(*p))
+			p++;
+		else if (permissive && *p == '/' && p + 1 < end && p[1] == '/')
+		{
+			while (p < end && *p != '\n' && *p != '\r')
+				p++;
+		}
+		else if (permissive && *p == '/' && p + 1 < end && p[1] == '*')
+		{
+			p += 2;
+			while (p + 1 < end && !(p[0] == '*' && p[1] == '/'))
+				p++;
+			if (p + 1 >= end)
+				return false;
+			p += 2;
+		}
+		else
+			break;
+	}
+	return true;
+}
+
+// parses a complete value through the tokens, on failure the result
+// points at the fragment so the caller can make the offset absolute
+bool json_parser::parse_fragment(const char *str, size_t length, json_var& var)
+{
+	if (lexical_analysis(str, length))
+	{
+		m_index = 0;
+		if (parse_value(var) && m_index == m_tokens.size() - 1)
+			return true;
+		fail_syntax(str, length);
+	}
+	m_result.source = str;
+	return false;
+}
+
+// keys without escapes are used in place
+bool json_parser::read_key(const char *&p, const char *end, std::string_view& key)
+{
+	if (p >= end || !(*p == '\"' || (mode == parse_mode::permissive && *p == '\'')))
+		return false;
+
+	char _quote = *p;
+	const char *_start = ++p;
+	p += json_plain_length(p, (size_t)(end - p), _quote);
+	if (p < end && *p == _quote)
+	{
+		key = std::string_view(_start, (size_t)(p - _start));
+		p++;
+		return true;
+	}
+
+	m_key.assign(_start, (size_t)(p - _start));
+	for (;;)
+	{
+		if (p >= end || is_ctrl(*p))
+			return false;
+		if (*p == _quote)
+			break;
+		if (*p != '\\')
+		{
+			m_key += *p++;
+			continue;
+		}
+
+		if (++p >= end)
+			return false;
+		char c = *p++;
+		switch (c)
+		{
+		case '\"': case '\\': case '/': m_key += c; break;
+		case 'b': m_key += '\b'; break;
+		case 'f': m_key += '\f'; break;
+		case 'n': m_key += '\n'; break;
+		case 'r': m_key += '\r'; break;
+		case 't': m_key += '\t'; break;
+		case 'u':
+		{
+			size_t n = json_unescape_unicode(p, (size_t)(end - p), m_key);
+			if (n == 0)
+				return false;
+			p += n;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	p++;
+	key = m_key;
+	return true;
+}
+
+// found is false when the value is not a container the node could select
+// members of, the caller leaves it out then. depth containers are open
+// around the value.
+bool json_parser::project_value(const char *&p, const char *end, const json_projection_node& node, json_var& var, bool& found, size_t depth)
+{
+	found = true;
+	const char *_start = p;
+	if (node.whole)
+		return json_validate_skip(p, end, mode, depth, max_depth) && parse_fragment(_start, (size_t)(p - _start), var);
+
+	if ((*p == '{' || *p == '[') && depth >= max_depth)
+	{
+		m_result.code = json_parse_error::too_deep;
+		m_result.source = p;
+		m_result.offset = 0;
+		return false;
+	}
+	if (*p == '{')
+	{
+		var = json_object();
+		return project_object(p, end, node, *var.value.object, depth + 1);
+	}
+	if (*p == '[')
+	{
+		var = json_array();
+		return project_array(p, end, node, *var.value.array, depth + 1);
+	}
+
+	found = false;
+	return json_validate_skip(p, end, mode, depth, max_depth);
+}
+
+// like json_doc::load the last of duplicate keys wins, an earlier member
+// is dropped when the last one is left out
+bool json_parser::project_object(const char *&p, const char *end, const json_projection_node& node, json_object& obj, size_t depth)
+{
+	bool _permissive = mode == parse_mode::permissive;
+	p++;
+	if (!skip_whitespace(p, end, _permissive))
+		return false;
+	if (p < end && *p == '}')
+	{
+		p++;
+		return true;
+	}
+
+	for (;;)
+	{
+		std::string_view _key;
+		if (!read_key(p, end, _key) || !skip_whitespace(p, end, _permissive) || p >= end || *p != ':')
+			return false;
+		p++;
+		if (!skip_whitespace(p, end, _permissive) || p >= end)
+			return false;
+
+		const json_projection_node *_child = node.find(_key);
+		if (_child != nullptr)
+		{
+			json_var _var;
+			bool _found;
+			if (!project_value(p, end, *_child, _var, _found, depth))
+				return false;
+			if (_found)
+				obj.get(_key) = std::move(_var);
+			else
+				obj.remove(_key);
+		}
+		else if (!json_validate_skip(p, end, mode, depth, max_depth))
+			return false;
+
+		if (!skip_whitespace(p, end, _permissive) || p >= end)
+			return false;
+		if (*p == '}')
+		{
+			p++;
+			return true;
+		}
+		if (*p++ != ',' || !skip_whitespace(p, end, _permissive))
+			return false;
+	}
+}
+
+// elements keep their index, the ones before a selected element are null
+bool json_parser::project_array(const char *&p, const char *end, const json_projection_node& node, json_array& arr, size_t depth)
+{
+	bool _permissive = mode == parse_mode::permissive;
+	p++;
+	if (!skip_whitespace(p, end, _permissive))
+		return false;
+	if (p < end && *p == ']')
+	{
+		p++;
+		return true;
+	}
+
+	for (size_t i = 0;; i++)
+	{
+		if (p >= end)
+			return false;
+
+		char _index[24];
+		int n = snprintf(_index, sizeof(_index), "%zu", i);
+		const json_projection_node *_child = node.find(std::string_view(_index, (size_t)n));
+		if (_child != nullptr)
+		{
+			arr.m_data.resize(i + 1);
+			bool _found;
+			if (!project_value(p, end, *_child, arr.m_data[i], _found, depth))
+				return false;
+			if (!_found)
+				arr.m_data.resize(i);
+		}
+		else if (!json_validate_skip(p, end, mode, depth, max_depth))
+			return false;
+
+		if (!skip_whitespace(p, end, _permissive) || p >= end)
+			return false;
+		if (*p == ']')
+		{
+			p++;
+			return true;
+		}
+		if (*p++ != ',' || !skip_whitespace(p, end, _permissive))
+			return false;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_parser
+//////////////////////////////////////////////////////////////////////////
+
+json_parser::json_parser()
+	: m_index(0), mode(parse_mode::strict), max_depth(JSON_PARSE_MAX_DEPTH), lazy_numbers(false), pack_numbers(true), schema(nullptr)
+{
+}
+
+json_parser::json_parser(parse_mode m)
+	: m_index(0), mode(m), max_depth(JSON_PARSE_MAX_DEPTH), lazy_numbers(false), pack_numbers(true), schema(nullptr)
+{
+}
+
+bool json_parser::parse(const char *str, json_object& obj)
+{
+	return parse(str, strlen(str), obj);
+}
+
+bool json_parser::parse(const char *str, size_t length, json_object& obj)
+{
+	obj = json_object();
+	return parse_into(str, length, obj);
+}
+
+bool json_parser::parse(const char *str, json_var& var)
+{
+	return parse(str, strlen(str), var);
+}
+
+bool json_parser::parse(const char *str, size_t length, json_var& var)
+{
+	var = json_object();
+	return parse_into(str, length, *var.value.object);
+}
+
+bool json_parser::parse_into(const char *str, json_object& obj)
+{
+	return parse_into(str, strlen(str), obj);
+}
+
+bool json_parser::parse_into(const char *str, size_t length, json_object& obj)
+{
+	JSON_STATS(bytes += length);
+	m_schema_result = json_schema_result();
+
+	bool success = false;
+	{
+		json_stats_timer _timer(&json_stats::lexical_ns);
+		success = lexical_analysis(str, length);
+	}
+	JSON_STATS(tokens += m_tokens.size() - 1);
+
+	if (!success)
+	{
+		m_result.source = str;
+		m_result.length = length;
+		m_schema_result.code = json_schema_error::not_parsed;
+		obj = json_object();
+		return false;
+	}
+
+	{
+		json_stats_timer _timer(&json_stats::syntax_ns);
+		success = syntax_analysis(obj);
+	}
+
+	if (!success)
+	{
+		fail_syntax(str, length);
+		if (m_result.code != json_parse_error::schema_mismatch)
+			m_schema_result.code = json_schema_error::not_parsed;
+		obj = json_object();
+		return false;
+	}
+
+	return success;
+}
+
+bool json_parser::parse_into(const char *str, json_var& var)
+{
+	return parse_into(str, strlen(str), var);
+}
+
+bool json_parser::parse_into(const char *str, size_t length, json_var& var)
+{
+	if (!var.is_object() || var.value.object->is_shared())
+		var = json_object();
+	return parse_into(str, length, *var.value.object);
+}
+
+bool json_parser::parse(const char *str, json_var& var, const json_projection& projection)
+{
+	return parse(str, strlen(str), var, projection);
+}
+
+bool json_parser::parse(const char *str, size_t length, json_var& var, const json_projection& projection)
+{
+	if (projection.root().whole)
+		return parse(str, length, var);
+
+	JSON_STATS(bytes += length);
+	json_stats_timer _timer(&json_stats::syntax_ns);
+
+	// the lexer stops on a null character, so does the projection
+	const char *p = str;
+	const char *end = str + strnlen(str, length);
+	m_result = json_parse_result();
+	var = json_object();
+	if (skip_whitespace(p, end, mode == parse_mode::permissive) && p < end && *p == '{' &&
+		project_object(p, end, projection.root(), *var.value.object, 1) &&
+		skip_whitespace(p, end, mode == parse_mode::permissive) && p == end)
+		return true;
+
+	if (m_result.code == json_parse_error::none)
+	{
+		m_result.code = p >= end ? json_parse_error::unexpected_end : json_parse_error::unexpected_token;
+		m_result.offset = (size_t)(p - str);
+	}
+	else
+		m_result.offset += (size_t)(m_result.source - str);
+	m_result.source = str;
+	m_result.length = length;
+	var = json_object();
+	return false;
+}
+
+void json_parser::clear()
+{
+	std::vector<json_token>().swap(m_tokens);
+	std::string().swap(m_text);
+	std::string().swap(m_key);
+	std::vector<json_parse_frame>().swap(m_stack);
+	m_index = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_parse_result
+//////////////////////////////////////////////////////////////////////////
+
+const char* json_parse_error_string(json_parse_error code)
+{
+	switch (code)
+	{
+	case json_parse_error::none:					return "no error";
+	case json_parse_error::unexpected_character:	return "unexpected character";
+	case json_parse_error::invalid_string:			return "invalid string";
+	case json_parse_error::invalid_number:			return "invalid number";
+	case json_parse_error::number_out_of_range:		return "number out of range";
+	case json_parse_error::invalid_literal:			return "invalid literal";
+	case json_parse_error::unexpected_token:		return "unexpected token";
+	case json_parse_error::unexpected_end:			return "unexpected end of input";
+	case json_parse_error::too_deep:				return "nesting too deep";
+	case json_parse_error::schema_mismatch:			return "does not match the schema";
+	case json_parse_error::cannot_read:				return "cannot read file";
+	}
+	return "unknown error";
+}
+
+void json_parse_result::locate() const
+{
+	if (m_line != 0 || source == nullptr)
+		return;
+	const size_t _end = std::min(offset, length);
+	size_t _start = 0;
+	m_line = 1;
+	for (const char *p = source; (p = (const char*)memchr(p, '\n', (size_t)(source + _end - p))) != nullptr; p++)
+	{
+		m_line++;
+		_start = (size_t)(p - source) + 1;
+	}
+	m_column = _end - _start + 1;
+}
\ No newline at end of file
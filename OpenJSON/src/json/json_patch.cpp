@@ -0,0 +1,391 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_patch.h>
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+// the member of obj named like the i-th member of other, found by position first
+static const json_var* find_member(const json_object& obj, const json_object& other, size_t i)
+{
+	const json_key& _key = other.get_key(i);
+	if (i < obj.count() && obj.get_key(i) == _key)
+		return &obj[i];
+	return obj.has(_key) ? &obj.get(_key) : nullptr;
+}
+
+// ~ is written ~0 and / is written ~1
+static void append_token(std::string& pointer, std::string_view token)
+{
+	pointer += '/';
+	for (char c : token)
+	{
+		if (c == '~')
+			pointer += "~0";
+		else if (c == '/')
+			pointer += "~1";
+		else
+			pointer += c;
+	}
+}
+
+// reads the token starting after the / at i, returns where the next one starts
+static size_t read_token(std::string_view pointer, size_t i, std::string& token)
+{
+	token.clear();
+	for (i++; i < pointer.size() && pointer[i] != '/'; i++)
+	{
+		if (pointer[i] == '~' && i + 1 < pointer.size() && (pointer[i + 1] == '0' || pointer[i + 1] == '1'))
+			token += pointer[++i] == '0' ? '~' : '/';
+		else
+			token += pointer[i];
+	}
+	return i;
+}
+
+// "-" stands for the end of the array
+static bool array_index(const std::string& token, size_t count, size_t& index)
+{
+	if (token == "-")
+	{
+		index = count;
+		return true;
+	}
+	if (token.empty() || token.size() > 18 || (token[0] == '0' && token.size() > 1))
+		return false;
+	index = 0;
+	for (char c : token)
+	{
+		if (c < '0' || c > '9')
+			return false;
+		index = index * 10 + (size_t)(c - '0');
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_diff
+//////////////////////////////////////////////////////////////////////////
+
+static void add_operation(json_array& ops, const char *op, const std::string& path, const json_var *value)
+{
+	json_var _op = json_object();
+	_op["op"] = op;
+	_op["path"] = path;
+	if (value != nullptr)
+		_op["value"] = *value;
+	ops.add(_op);
+}
+
+static void diff(const json_var& a, const json_var& b, std::string& path, json_array& ops)
+{
+	if (a.type != b.type || (!a.is_object() && !a.is_array()))
+	{
+		if (!(a == b))
+			add_operation(ops, "replace", path, &b);
+		return;
+	}
+	// unequal hashes tell right away that the subtrees differ, equal ones are compared once
+	if (json_hash(a) == json_hash(b) && a == b)
+		return;
+
+	size_t _length = path.size();
+	if (a.is_object())
+	{
+		const json_object& _a = *a.value.object;
+		const json_object& _b = *b.value.object;
+		for (size_t i = 0; i < _a.count(); i++)
+		{
+			const json_var *_other = find_member(_b, _a, i);
+			append_token(path, _a.get_key(i));
+			if (_other == nullptr)
+				add_operation(ops, "remove", path, nullptr);
+			else
+				diff(_a[i], *_other, path, ops);
+			path.resize(_length);
+		}
+		for (size_t i = 0; i < _b.count(); i++)
+			if (find_member(_a, _b, i) == nullptr)
+			{
+				append_token(path, _b.get_key(i));
+				add_operation(ops, "add", path, &_b[i]);
+				path.resize(_length);
+			}
+	}
+	else
+	{
+		const json_array& _a = *a.value.array;
+		const json_array& _b = *b.value.array;
+		size_t _common = std::min(_a.count(), _b.count());
+		for (size_t i = 0; i < _common; i++)
+		{
+			append_token(path, std::to_string(i));
+			diff(_a[i], _b[i], path, ops);
+			path.resize(_length);
+		}
+		for (size_t i = _common; i < _b.count(); i++)
+		{
+			append_token(path, std::to_string(i));
+			add_operation(ops, "add", path, &_b[i]);
+			path.resize(_length);
+		}
+		// from the end so that the indices stay valid
+		for (size_t i = _a.count(); i > _common; i--)
+		{
+			append_token(path, std::to_string(i - 1));
+			add_operation(ops, "remove", path, nullptr);
+			path.resize(_length);
+		}
+	}
+}
+
+static json_var merge_diff(const json_var& a, const json_var& b)
+{
+	if (!a.is_object() || !b.is_object())
+		return b;
+
+	json_var _patch = json_object();
+	json_object& _p = _patch.to_object();
+	if (a.node() == b.node())
+		return _patch;
+
+	const json_object& _a = *a.value.object;
+	const json_object& _b = *b.value.object;
+	for (size_t i = 0; i < _a.count(); i++)
+		if (find_member(_b, _a, i) == nullptr)
+			_p.get(_a.get_key(i)) = nullptr;
+
+	for (size_t i = 0; i < _b.count(); i++)
+	{
+		const json_var *_old = find_member(_a, _b, i);
+		if (_old == nullptr)
+			_p.get(_b.get_key(i)) = _b[i];
+		else if (!(*_old == _b[i]))
+			_p.get(_b.get_key(i)) = merge_diff(*_old, _b[i]);
+	}
+	return _patch;
+}
+
+json_var json_diff(const json_var& a, const json_var& b, json_patch_format format)
+{
+	if (format == json_patch_format::merge_patch)
+		return a == b ? json_var(json_object()) : merge_diff(a, b);
+
+	json_var _ops = json_array();
+	std::string _path;
+	diff(a, b, _path, _ops.to_array());
+	return _ops;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_apply_patch
+//////////////////////////////////////////////////////////////////////////
+
+// the value a pointer refers to, containers on the way are detached
+static json_var* locate(json_var& root, std::string_view pointer)
+{
+	json_var *_var = &root;
+	std::string _token;
+	size_t i = 0;
+	while (i < pointer.size())
+	{
+		if (pointer[i] != '/')
+			return nullptr;
+		i = read_token(pointer, i, _token);
+
+		if (_var->is_object())
+		{
+			json_object& _obj = _var->to_object();
+			if (!_obj.has(_token))
+				return nullptr;
+			_var = &_obj.get(_token);
+		}
+		else if (_var->is_array())
+		{
+			json_array& _arr = _var->to_array();
+			size_t _index;
+			if (!array_index(_token, _arr.count(), _index) || _index >= _arr.count())
+				return nullptr;
+			_var = &_arr[_index];
+		}
+		else
+			return nullptr;
+	}
+	return _var;
+}
+
+// splits a pointer into the container it points in and the last token
+static json_var* locate_parent(json_var& root, std::string_view pointer, std::string& token)
+{
+	size_t _slash = pointer.rfind('/');
+	if (_slash == std::string_view::npos)
+		return nullptr;
+	read_token(pointer, _slash, token);
+	return locate(root, pointer.substr(0, _slash));
+}
+
+static bool add(json_var& root, std::string_view path, const json_var& value)
+{
+	if (path.empty())
+	{
+		root = json_var(value);
+		return true;
+	}
+
+	std::string _token;
+	json_var *_parent = locate_parent(root, path, _token);
+	if (_parent == nullptr)
+		return false;
+
+	if (_parent->is_object())
+	{
+		_parent->to_object().get(_token) = value;
+		return true;
+	}
+	if (_parent->is_array())
+	{
+		json_array& _arr = _parent->to_array();
+		size_t _index;
+		if (!array_index(_token, _arr.count(), _index) || _index > _arr.count())
+			return false;
+		_arr.insert(_index, value);
+		return true;
+	}
+	return false;
+}
+
+static bool remove(json_var& root, std::string_view path)
+{
+	std::string _token;
+	json_var *_parent = locate_parent(root, path, _token);
+	if (_parent == nullptr)
+		return false;
+
+	if (_parent->is_object())
+		return _parent->to_object().remove(_token);
+	if (_parent->is_array())
+	{
+		json_array& _arr = _parent->to_array();
+		size_t _index;
+		if (!array_index(_token, _arr.count(), _index) || _index >= _arr.count())
+			return false;
+		_arr.remove(_index);
+		return true;
+	}
+	return false;
+}
+
+static bool apply_operation(json_var& root, const json_var& op)
+{
+	if (!op.is_object())
+		return false;
+	const json_object& _op = op.to_object();
+	if (!_op.has("op") || !_op.get("op").is_string() || !_op.has("path") || !_op.get("path").is_string())
+		return false;
+
+	std::string _name = _op.get("op").to_string();
+	std::string _path = _op.get("path").to_string();
+
+	if (_name == "add" || _name == "replace" || _name == "test")
+	{
+		if (!_op.has("value"))
+			return false;
+		const json_var& _value = _op.get("value");
+		if (_name == "add")
+			return add(root, _path, _value);
+
+		json_var *_target = locate(root, _path);
+		if (_target == nullptr)
+			return false;
+		if (_name == "test")
+			return *_target == _value;
+		*_target = _value;
+		return true;
+	}
+
+	if (_name == "remove")
+		return remove(root, _path);
+
+	if (_name == "move" || _name == "copy")
+	{
+		if (!_op.has("from") || !_op.get("from").is_string())
+			return false;
+		std::string _from = _op.get("from").to_string();
+		json_var *_source = locate(root, _from);
+		if (_source == nullptr)
+			return false;
+		json_var _value = *_source;
+		if (_name == "copy")
+			return add(root, _path, _value);
+
+		// a value cannot be moved into one of its own children
+		if (_path.size() > _from.size() && _path.compare(0, _from.size(), _from) == 0 && _path[_from.size()] == '/')
+			return false;
+		return _from == _path || (remove(root, _from) && add(root, _path, _value));
+	}
+
+	return false;
+}
+
+static void merge(json_var& target, const json_var& patch)
+{
+	if (!patch.is_object())
+	{
+		target = patch;
+		return;
+	}
+	if (!target.is_object())
+		target = json_object();
+
+	json_object& _target = target.to_object();
+	const json_object& _patch = patch.to_object();
+	for (size_t i = 0; i < _patch.count(); i++)
+	{
+		if (_patch[i].is_null())
+			_target.remove(_patch.get_key(i));
+		else
+			merge(_target.get(_patch.get_key(i)), _patch[i]);
+	}
+}
+
+bool json_apply_patch(json_var& var, const json_var& patch, json_patch_format format)
+{
+	if (format == json_patch_format::merge_patch)
+	{
+		merge(var, patch);
+		return true;
+	}
+
+	if (!patch.is_array())
+		return false;
+
+	// the operations work on a copy, with JSON_ENABLE_COW only the paths they touch are cloned
+	json_var _work = var;
+	const json_array& _ops = patch.to_array();
+	for (size_t i = 0; i < _ops.count(); i++)
+		if (!apply_operation(_work, _ops[i]))
+			return false;
+
+	var = std::move(_work);
+	return true;
+}
\ No newline at end of file
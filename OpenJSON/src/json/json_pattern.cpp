@@ -0,0 +1,616 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_pattern.h>
+
+#include <algorithm>
+
+// groups nested deeper do not compile, the compiler recurses on them
+static constexpr size_t JSON_PATTERN_MAX_DEPTH = 256;
+
+// no code point, before the first one and after the last one
+static constexpr uint32_t JSON_PATTERN_NONE = 0xffffffff;
+
+static constexpr uint32_t JSON_PATTERN_LAST = 0x10ffff;
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+// the code point at p, a byte that does not start a well formed sequence
+// stands for itself
+static uint32_t decode(const uint8_t *p, const uint8_t *end, size_t& length)
+{
+	uint8_t c = p[0];
+	size_t n = c >= 0xf0 && c <= 0xf4 ? 4 : c >= 0xe0 ? 3 : c >= 0xc2 && c <= 0xdf ? 2 : 1;
+	if (c < 0x80 || c > 0xf4 || (size_t)(end - p) < n)
+		n = 1;
+	uint32_t cp = n == 1 ? c : n == 2 ? c & 0x1f : n == 3 ? c & 0x0f : c & 0x07;
+	for (size_t i = 1; i < n; i++)
+	{
+		if ((p[i] & 0xc0) != 0x80)
+		{
+			length = 1;
+			return c;
+		}
+		cp = (cp << 6) | (p[i] & 0x3f);
+	}
+	length = n;
+	return cp;
+}
+
+static inline bool is_word(uint32_t cp)
+{
+	return (cp >= '0' && cp <= '9') || (cp >= 'A' && cp <= 'Z') || (cp >= 'a' && cp <= 'z') || cp == '_';
+}
+
+static inline bool is_line_terminator(uint32_t cp)
+{
+	return cp == '\n' || cp == '\r' || cp == 0x2028 || cp == 0x2029;
+}
+
+static inline int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+		return (c | 0x20) - 'a' + 10;
+	return -1;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_pattern::compiler
+//////////////////////////////////////////////////////////////////////////
+
+class json_pattern::compiler
+{
+private:
+	std::vector<instruction>& m_code;
+	std::vector<set>& m_sets;
+	const char *p;
+	const char *m_end;
+	size_t m_depth = 0;
+
+	inline bool emit(op code, int32_t arg = 0, int32_t next = 1)
+	{
+		m_code.push_back({ code, next, arg });
+		return m_code.size() <= JSON_PATTERN_MAX_PROGRAM;
+	}
+
+	inline bool emit_set(set&& s)
+	{
+		m_sets.push_back(std::move(s));
+		return emit(op::set, (int32_t)m_sets.size() - 1);
+	}
+
+	bool alternation();
+	bool sequence();
+	bool term();
+	bool atom(bool& quantifiable);
+	bool braces(size_t& min, size_t& max);
+	bool quantifier(size_t start);
+	bool char_class();
+	bool escape(set& s, uint32_t& cp, bool& is_set, bool in_class);
+	bool hex(size_t digits, uint32_t& cp);
+	uint32_t code_point();
+
+	static void add_complement(std::vector<range>& ranges, std::vector<range> of);
+
+public:
+	compiler(json_pattern& pattern, std::string_view source)
+		: m_code(pattern.m_program), m_sets(pattern.m_sets), p(source.data()), m_end(source.data() + source.size())
+	{
+	}
+
+	bool run()
+	{
+		return alternation() && p == m_end && emit(op::match);
+	}
+};
+
+uint32_t json_pattern::compiler::code_point()
+{
+	size_t n;
+	uint32_t cp = decode((const uint8_t*)p, (const uint8_t*)m_end, n);
+	p += n;
+	return cp;
+}
+
+// the ranges of [0, JSON_PATTERN_LAST] outside of of
+void json_pattern::compiler::add_complement(std::vector<range>& ranges, std::vector<range> of)
+{
+	std::sort(of.begin(), of.end(), [](const range& a, const range& b) { return a.first < b.first; });
+	uint32_t _next = 0;
+	for (const range& r : of)
+	{
+		if (r.first > _next)
+			ranges.push_back({ _next, r.first - 1 });
+		if (r.last >= _next)
+			_next = r.last + 1;
+	}
+	if (_next <= JSON_PATTERN_LAST)
+		ranges.push_back({ _next, JSON_PATTERN_LAST });
+}
+
+// alternatives are chained splits, each one jumps to the end once it matched
+bool json_pattern::compiler::alternation()
+{
+	const size_t _start = m_code.size();
+	std::vector<size_t> _jumps;
+	if (!sequence())
+		return false;
+	while (p < m_end && *p == '|')
+	{
+		p++;
+		m_code.insert(m_code.begin() + (ptrdiff_t)_start, { op::split, 1, 0 });
+		for (size_t& j : _jumps)
+			j++;
+		_jumps.push_back(m_code.size());
+		if (!emit(op::jump))
+			return false;
+		m_code[_start].arg = (int32_t)(m_code.size() - _start);
+		if (!sequence())
+			return false;
+	}
+	for (size_t j : _jumps)
+		m_code[j].arg = (int32_t)(m_code.size() - j);
+	return m_code.size() <= JSON_PATTERN_MAX_PROGRAM;
+}
+
+bool json_pattern::compiler::sequence()
+{
+	while (p < m_end && *p != '|' && *p != ')')
+		if (!term())
+			return false;
+	return true;
+}
+
+bool json_pattern::compiler::term()
+{
+	const size_t _start = m_code.size();
+	bool _quantifiable;
+	if (!atom(_quantifiable))
+		return false;
+
+	size_t _min, _max;
+	const char *_at = p;
+	const bool _quantified = p < m_end && (*p == '*' || *p == '+' || *p == '?' || (*p == '{' && braces(_min, _max)));
+	p = _at;
+	if (!_quantified)
+		return true;
+	return _quantifiable && quantifier(_start);
+}
+
+// {n}, {n,} or {n,m}, p is left after it. false, with p anywhere, when the
+// brace does not start one and is a plain character
+bool json_pattern::compiler::braces(size_t& min, size_t& max)
+{
+	auto _number = [&](size_t& n)
+	{
+		if (p >= m_end || *p < '0' || *p > '9')
+			return false;
+		n = 0;
+		while (p < m_end && *p >= '0' && *p <= '9')
+		{
+			// past the size of any program, the exact count does not matter
+			if (n <= JSON_PATTERN_MAX_PROGRAM)
+				n = n * 10 + (size_t)(*p - '0');
+			p++;
+		}
+		return true;
+	};
+
+	p++;
+	if (!_number(min))
+		return false;
+	max = min;
+	if (p < m_end && *p == ',')
+	{
+		p++;
+		max = SIZE_MAX;
+		if (p < m_end && *p != '}' && !_number(max))
+			return false;
+	}
+	if (p >= m_end || *p != '}')
+		return false;
+	p++;
+	return true;
+}
+
+// the atom from start is copied as many times as it has to match, then
+// once more as an optional part or a loop. lazy quantifiers match the same
+// strings, only which match is found first differs.
+bool json_pattern::compiler::quantifier(size_t start)
+{
+	size_t _min = 0, _max = SIZE_MAX;
+	if (*p == '*')
+		p++;
+	else if (*p == '+')
+	{
+		_min = 1;
+		p++;
+	}
+	else if (*p == '?')
+	{
+		_max = 1;
+		p++;
+	}
+	else
+		braces(_min, _max);
+	if (p < m_end && *p == '?')
+		p++;
+	if (_min > _max)
+		return false;
+
+	const std::vector<instruction> _atom(m_code.begin() + (ptrdiff_t)start, m_code.end());
+	const size_t _length = _atom.size();
+	const size_t _copies = _min + (_max == SIZE_MAX ? 1 : _max - _min);
+	if (_copies > JSON_PATTERN_MAX_PROGRAM || start + _copies * (_length + 2) > JSON_PATTERN_MAX_PROGRAM)
+		return false;
+
+	m_code.resize(start);
+	for (size_t i = 0; i < _min; i++)
+		m_code.insert(m_code.end(), _atom.begin(), _atom.end());
+	if (_max == SIZE_MAX && _min > 0)
+		return emit(op::split, -(int32_t)_length);	// back to the last copy
+	if (_max == SIZE_MAX)
+	{
+		emit(op::split, (int32_t)_length + 2);
+		m_code.insert(m_code.end(), _atom.begin(), _atom.end());
+		return emit(op::jump, -(int32_t)_length - 1);
+	}
+	for (size_t i = _min; i < _max; i++)
+	{
+		emit(op::split, (int32_t)_length + 1);
+		m_code.insert(m_code.end(), _atom.begin(), _atom.end());
+	}
+	return m_code.size() <= JSON_PATTERN_MAX_PROGRAM;
+}
+
+bool json_pattern::compiler::atom(bool& quantifiable)
+{
+	quantifiable = true;
+	switch (*p)
+	{
+	case '(':
+	{
+		p++;
+		// only non capturing groups, captures are not needed to match
+		if (p < m_end && *p == '?')
+		{
+			if (p + 1 >= m_end || p[1] != ':')
+				return false;
+			p += 2;
+		}
+		if (++m_depth > JSON_PATTERN_MAX_DEPTH || !alternation() || p >= m_end || *p != ')')
+			return false;
+		m_depth--;
+		p++;
+		return true;
+	}
+	case '[':
+		return char_class();
+	case '.':
+		p++;
+		return emit(op::any);
+	case '^':
+		p++;
+		quantifiable = false;
+		return emit(op::begin);
+	case '$':
+		p++;
+		quantifiable = false;
+		return emit(op::end);
+	case '*': case '+': case '?':
+		return false;	// nothing to repeat
+	case '{':
+	{
+		size_t _min, _max;
+		const char *_at = p;
+		if (braces(_min, _max))
+			return false;
+		p = _at + 1;
+		return emit(op::code, '{');
+	}
+	case '\\':
+	{
+		if (++p >= m_end)
+			return false;
+		if (*p == 'b' || *p == 'B')
+		{
+			quantifiable = false;
+			return emit(*p++ == 'b' ? op::word : op::not_word);
+		}
+		set _s;
+		uint32_t _cp;
+		bool _is_set;
+		if (!escape(_s, _cp, _is_set, false))
+			return false;
+		return _is_set ? emit_set(std::move(_s)) : emit(op::code, (int32_t)_cp);
+	}
+	default:
+		return emit(op::code, (int32_t)code_point());
+	}
+}
+
+bool json_pattern::compiler::hex(size_t digits, uint32_t& cp)
+{
+	if ((size_t)(m_end - p) < digits)
+		return false;
+	cp = 0;
+	for (size_t i = 0; i < digits; i++)
+	{
+		int v = hex_value(*p++);
+		if (v < 0)
+			return false;
+		cp = (cp << 4) | (uint32_t)v;
+	}
+	return true;
+}
+
+// p is after the backslash. \d \w \s and their complements are sets, the
+// rest are code points. escapes of letters and digits that ECMAScript does
+// not define, backreferences included, are refused.
+bool json_pattern::compiler::escape(set& s, uint32_t& cp, bool& is_set, bool in_class)
+{
+	static const range _digits[] = { { '0', '9' } };
+	static const range _words[] = { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } };
+	static const range _spaces[] = { { '\t', '\r' }, { ' ', ' ' }, { 0xa0, 0xa0 }, { 0x1680, 0x1680 }, { 0x2000, 0x200a },
+		{ 0x2028, 0x2029 }, { 0x202f, 0x202f }, { 0x205f, 0x205f }, { 0x3000, 0x3000 }, { 0xfeff, 0xfeff } };
+
+	is_set = false;
+	const char c = *p++;
+	auto _class = [&](const range *first, const range *last, bool complement)
+	{
+		is_set = true;
+		if (complement)
+			add_complement(s.ranges, std::vector<range>(first, last));
+		else
+			s.ranges.insert(s.ranges.end(), first, last);
+		return true;
+	};
+
+	switch (c)
+	{
+	case 'd': return _class(std::begin(_digits), std::end(_digits), false);
+	case 'D': return _class(std::begin(_digits), std::end(_digits), true);
+	case 'w': return _class(std::begin(_words), std::end(_words), false);
+	case 'W': return _class(std::begin(_words), std::end(_words), true);
+	case 's': return _class(std::begin(_spaces), std::end(_spaces), false);
+	case 'S': return _class(std::begin(_spaces), std::end(_spaces), true);
+	case 't': cp = '\t'; return true;
+	case 'n': cp = '\n'; return true;
+	case 'v': cp = '\v'; return true;
+	case 'f': cp = '\f'; return true;
+	case 'r': cp = '\r'; return true;
+	case 'b':
+		cp = '\b';
+		return in_class;
+	case '0':
+		cp = 0;
+		return p >= m_end || *p < '0' || *p > '9';
+	case 'x':
+		return hex(2, cp);
+	case 'u':
+	{
+		if (!hex(4, cp))
+			return false;
+		// a surrogate pair written as two escapes is one code point
+		uint32_t _low;
+		const char *_at = p;
+		if (cp >= 0xd800 && cp <= 0xdbff && m_end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+		{
+			p += 2;
+			if (hex(4, _low) && _low >= 0xdc00 && _low <= 0xdfff)
+				cp = 0x10000 + ((cp - 0xd800) << 10) + (_low - 0xdc00);
+			else
+				p = _at;
+		}
+		return true;
+	}
+	case 'c':
+		if (p >= m_end || !((*p | 0x20) >= 'a' && (*p | 0x20) <= 'z'))
+			return false;
+		cp = (uint32_t)(*p++ % 32);
+		return true;
+	default:
+		if ((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'))
+			return false;
+		p--;
+		cp = code_point();
+		return true;
+	}
+}
+
+// ']' right after '[' or "[^" closes an empty class, as in ECMAScript
+bool json_pattern::compiler::char_class()
+{
+	set _s;
+	p++;
+	if (p < m_end && *p == '^')
+	{
+		_s.negated = true;
+		p++;
+	}
+
+	auto _atom = [&](uint32_t& cp, bool& is_set)
+	{
+		if (p >= m_end)
+			return false;
+		if (*p != '\\')
+		{
+			is_set = false;
+			cp = code_point();
+			return true;
+		}
+		if (++p >= m_end)
+			return false;
+		return escape(_s, cp, is_set, true);
+	};
+
+	for (;;)
+	{
+		if (p >= m_end)
+			return false;
+		if (*p == ']')
+		{
+			p++;
+			break;
+		}
+
+		uint32_t _first, _last;
+		bool _is_set;
+		if (!_atom(_first, _is_set))
+			return false;
+		if (_is_set)
+			continue;
+		if (p + 1 < m_end && *p == '-' && p[1] != ']')
+		{
+			p++;
+			if (!_atom(_last, _is_set) || _is_set || _last < _first)
+				return false;
+			_s.ranges.push_back({ _first, _last });
+		}
+		else
+			_s.ranges.push_back({ _first, _first });
+	}
+	return emit_set(std::move(_s));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_pattern
+//////////////////////////////////////////////////////////////////////////
+
+bool json_pattern::compile(std::string_view pattern)
+{
+	m_program.clear();
+	m_sets.clear();
+	if (compiler(*this, pattern).run())
+		return true;
+	m_program.clear();
+	m_sets.clear();
+	return false;
+}
+
+bool json_pattern::in_set(const set& s, uint32_t cp) const
+{
+	for (const range& r : s.ranges)
+		if (cp >= r.first && cp <= r.last)
+			return !s.negated;
+	return s.negated;
+}
+
+// follows the splits, jumps and assertions from pc, the instructions that
+// read a code point are added to threads. prev and next are around the
+// position. a stack rather than recursion, marks keep empty loops finite.
+bool json_pattern::step(std::vector<uint32_t>& threads, std::vector<uint32_t>& marks, std::vector<int32_t>& stack,
+	uint32_t generation, int32_t pc, uint32_t prev, uint32_t next) const
+{
+	stack.clear();
+	stack.push_back(pc);
+	while (!stack.empty())
+	{
+		const int32_t i = stack.back();
+		stack.pop_back();
+		if (marks[(size_t)i] == generation)
+			continue;
+		marks[(size_t)i] = generation;
+
+		const instruction& _in = m_program[(size_t)i];
+		switch (_in.code)
+		{
+		case op::split:
+			stack.push_back(i + _in.arg);
+			stack.push_back(i + _in.next);
+			break;
+		case op::jump:
+			stack.push_back(i + _in.arg);
+			break;
+		case op::begin:
+			if (prev == JSON_PATTERN_NONE)
+				stack.push_back(i + 1);
+			break;
+		case op::end:
+			if (next == JSON_PATTERN_NONE)
+				stack.push_back(i + 1);
+			break;
+		case op::word:
+		case op::not_word:
+			if ((is_word(prev) != is_word(next)) == (_in.code == op::word))
+				stack.push_back(i + 1);
+			break;
+		case op::match:
+			return true;
+		default:
+			threads.push_back((uint32_t)i);
+			break;
+		}
+	}
+	return false;
+}
+
+// every thread moves over a code point at once, a new one starts at each
+// position since the match can be anywhere
+bool json_pattern::search(const char *str, size_t length) const
+{
+	if (m_program.empty())
+		return false;
+
+	std::vector<uint32_t> _current, _next;
+	std::vector<uint32_t> _marks(m_program.size(), 0);
+	std::vector<int32_t> _stack;
+	const bool _anchored = m_program[0].code == op::begin;
+
+	const uint8_t *s = (const uint8_t*)str;
+	const uint8_t *end = s + length;
+	uint32_t _generation = 1;
+	uint32_t _prev = JSON_PATTERN_NONE;
+	size_t _length = 0;
+	uint32_t _cp = s < end ? decode(s, end, _length) : JSON_PATTERN_NONE;
+	for (;;)
+	{
+		if (step(_current, _marks, _stack, _generation, 0, _prev, _cp))
+			return true;
+		if (_cp == JSON_PATTERN_NONE || (_anchored && _current.empty()))
+			return false;
+
+		const uint8_t *_after = s + _length;
+		size_t _after_length = 0;
+		const uint32_t _after_cp = _after < end ? decode(_after, end, _after_length) : JSON_PATTERN_NONE;
+		_generation++;
+		_next.clear();
+		for (uint32_t pc : _current)
+		{
+			const instruction& _in = m_program[pc];
+			const bool _read = _in.code == op::code ? (uint32_t)_in.arg == _cp
+				: _in.code == op::any ? !is_line_terminator(_cp)
+				: in_set(m_sets[(size_t)_in.arg], _cp);
+			if (_read && step(_next, _marks, _stack, _generation, (int32_t)pc + 1, _cp, _after_cp))
+				return true;
+		}
+
+		std::swap(_current, _next);
+		s = _after;
+		_prev = _cp;
+		_cp = _after_cp;
+		_length = _after_length;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_projection.h>
+
+//////////////////////////////////////////////////////////////////////////
+// json_projection_node
+//////////////////////////////////////////////////////////////////////////
+
+const json_projection_node* json_projection_node::find(std::string_view key) const
+{
+	const json_projection_node *_any = nullptr;
+	for (const json_projection_node& c : children)
+	{
+		if (c.name == key)
+			return &c;
+		if (c.name == "*")
+			_any = &c;
+	}
+	return _any;
+}
+
+json_projection_node& json_projection_node::child(std::string_view key)
+{
+	for (json_projection_node& c : children)
+		if (c.name == key)
+			return c;
+	children.push_back({ std::string(key), false, {} });
+	return children.back();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_projection
+//////////////////////////////////////////////////////////////////////////
+
+json_projection::json_projection(std::initializer_list<std::string_view> pointers)
+{
+	for (std::string_view p : pointers)
+		add(p);
+}
+
+json_projection& json_projection::add(std::string_view pointer)
+{
+	JSON_ASSERT(pointer.empty() || pointer[0] == '/', "json_projection : a pointer starts with /");
+
+	json_projection_node *_node = &m_root;
+	size_t i = 0;
+	while (i < pointer.size() && !_node->whole)
+	{
+		size_t _end = pointer.find('/', i + 1);
+		if (_end == std::string_view::npos)
+			_end = pointer.size();
+
+		// ~1 stands for / and ~0 for ~
+		std::string _name;
+		for (size_t j = i + 1; j < _end; j++)
+		{
+			if (pointer[j] == '~' && j + 1 < _end && (pointer[j + 1] == '0' || pointer[j + 1] == '1'))
+				_name += pointer[++j] == '0' ? '~' : '/';
+			else
+				_name += pointer[j];
+		}
+
+		_node = &_node->child(_name);
+		i = _end;
+	}
+
+	_node->whole = true;
+	_node->children.clear();
+	return *this;
+}
\ No newline at end of file
@@ -0,0 +1,616 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_schema.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+// bits of json_schema_node::types, one per json_type and one for integers
+static constexpr uint8_t type_bit(json_type type) { return (uint8_t)(1 << (int)type); }
+static constexpr uint8_t JSON_SCHEMA_INTEGER = 1 << 6;
+
+// bits of json_schema_node::flags
+enum : uint8_t
+{
+	JSON_SCHEMA_MINIMUM = 1,
+	JSON_SCHEMA_MAXIMUM = 2,
+	JSON_SCHEMA_EXCLUSIVE_MINIMUM = 4,
+	JSON_SCHEMA_EXCLUSIVE_MAXIMUM = 8,
+	JSON_SCHEMA_MULTIPLE_OF = 16
+};
+
+static inline uint64_t hash_key(std::string_view key)
+{
+	return (uint64_t)std::hash<std::string_view>()(key);
+}
+
+void json_append_pointer(std::string& path, std::string_view segment)
+{
+	path += '/';
+	for (char c : segment)
+	{
+		if (c == '~')
+			path += "~0";
+		else if (c == '/')
+			path += "~1";
+		else
+			path += c;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// compiler
+//////////////////////////////////////////////////////////////////////////
+
+bool json_schema::fail(const std::string& path, const char *what)
+{
+	m_error = what;
+	m_error += " at \"" + path + "\"";
+	return false;
+}
+
+// keywords that do not constrain anything
+static bool is_annotation(std::string_view key)
+{
+	static const char *_keys[] = { "$schema", "$id", "id", "$comment", "title", "description", "default",
+		"examples", "format", "readOnly", "writeOnly", "deprecated", "definitions", "$defs" };
+	for (const char *k : _keys)
+		if (key == k)
+			return true;
+	return false;
+}
+
+static bool read_size(const json_var& var, size_t& size)
+{
+	if (!var.is_number() || var.to_double() < 0 || var.to_double() != std::floor(var.to_double()))
+		return false;
+	size = (size_t)var.to_double();
+	return true;
+}
+
+static bool read_type(const json_var& var, uint8_t& types)
+{
+	if (!var.is_string())
+		return false;
+	const std::string_view _name(var.to_string().get(), var.to_string().size());
+	if (_name == "null")			types |= type_bit(json_type::null);
+	else if (_name == "boolean")	types |= type_bit(json_type::boolean);
+	else if (_name == "object")		types |= type_bit(json_type::object);
+	else if (_name == "array")		types |= type_bit(json_type::array);
+	else if (_name == "string")		types |= type_bit(json_type::string);
+	else if (_name == "number")		types |= type_bit(json_type::number);
+	else if (_name == "integer")	types |= JSON_SCHEMA_INTEGER;
+	else
+		return false;
+	return true;
+}
+
+// returns the index of the node, any or none for the boolean schemas, and
+// something below none when the schema does not compile
+int32_t json_schema::compile_node(const json_var& schema, std::string& path)
+{
+	constexpr int32_t _failed = json_schema_node::none - 1;
+	if (schema.is_boolean())
+		return schema.to_boolean() ? json_schema_node::any : json_schema_node::none;
+	if (!schema.is_object())
+		return fail(path, "a schema has to be an object or a boolean"), _failed;
+
+	const int32_t _index = (int32_t)m_nodes.size();
+	m_nodes.emplace_back();
+	json_schema_node _n;
+	const size_t _length = path.size();
+	bool _exclusive_min = false, _exclusive_max = false;	// draft 4 booleans
+	bool _has_min = false, _has_max = false, _has_xmin = false, _has_xmax = false;
+	double _xmin = 0, _xmax = 0;
+	const json_var *_items = nullptr, *_prefix = nullptr, *_additional_items = nullptr;
+	std::vector<std::pair<std::string_view, const json_var*>> _properties;
+	std::vector<std::string_view> _required;
+
+	for (const auto& [key, value] : schema.to_object())
+	{
+		path.resize(_length);
+		json_append_pointer(path, key);
+
+		if (key == "type")
+		{
+			_n.types = 0;
+			if (value.is_array())
+			{
+				for (const json_var& t : value.to_array())
+					if (!read_type(t, _n.types))
+						return fail(path, "unknown type"), _failed;
+			}
+			else if (!read_type(value, _n.types))
+				return fail(path, "unknown type"), _failed;
+		}
+		else if (key == "enum" || key == "const")
+		{
+			if (key == "enum" && !value.is_array())
+				return fail(path, "enum has to be an array"), _failed;
+			_n.enums = (uint32_t)m_enums.size();
+			if (key == "const")
+				m_enums.push_back(value);
+			else
+				for (const json_var& v : value.to_array())
+					m_enums.push_back(v);
+			_n.enum_count = (uint32_t)(m_enums.size() - _n.enums);
+		}
+		else if (key == "minimum" || key == "maximum" || key == "exclusiveMinimum" || key == "exclusiveMaximum" || key == "multipleOf")
+		{
+			if (value.is_boolean() && (key == "exclusiveMinimum" || key == "exclusiveMaximum"))
+			{
+				(key == "exclusiveMinimum" ? _exclusive_min : _exclusive_max) = value.to_boolean();
+				continue;
+			}
+			if (!value.is_number())
+				return fail(path, "a bound has to be a number"), _failed;
+			const double _v = value.to_double();
+			if (key == "minimum")				{ _n.minimum = _v; _has_min = true; }
+			else if (key == "maximum")			{ _n.maximum = _v; _has_max = true; }
+			else if (key == "exclusiveMinimum")	{ _xmin = _v; _has_xmin = true; }
+			else if (key == "exclusiveMaximum")	{ _xmax = _v; _has_xmax = true; }
+			else if (_v > 0)
+			{
+				_n.multiple_of = _v;
+				_n.flags |= JSON_SCHEMA_MULTIPLE_OF;
+			}
+			else
+				return fail(path, "multipleOf has to be positive"), _failed;
+		}
+		else if (key == "minLength" || key == "maxLength" || key == "minItems" || key == "maxItems" || key == "minProperties" || key == "maxProperties")
+		{
+			size_t _v;
+			if (!read_size(value, _v))
+				return fail(path, "a count has to be a positive integer"), _failed;
+			if (key == "minLength")				_n.min_length = _v;
+			else if (key == "maxLength")		_n.max_length = _v;
+			else if (key == "minItems")			_n.min_items = _v;
+			else if (key == "maxItems")			_n.max_items = _v;
+			else if (key == "minProperties")	_n.min_properties = _v;
+			else								_n.max_properties = _v;
+		}
+		else if (key == "pattern")
+		{
+			if (!value.is_string())
+				return fail(path, "pattern has to be a string"), _failed;
+			json_pattern& _pattern = m_patterns.emplace_back();
+			if (!_pattern.compile(std::string_view(value.to_string().get(), value.to_string().size())))
+				return fail(path, "invalid or unsupported pattern"), _failed;
+			_n.pattern = (int32_t)m_patterns.size() - 1;
+		}
+		else if (key == "properties")
+		{
+			if (!value.is_object())
+				return fail(path, "properties has to be an object"), _failed;
+			for (const auto& [name, sub] : value.to_object())
+				_properties.emplace_back(std::string_view(name), &sub);
+		}
+		else if (key == "required")
+		{
+			if (!value.is_array())
+				return fail(path, "required has to be an array"), _failed;
+			for (const json_var& r : value.to_array())
+			{
+				if (!r.is_string())
+					return fail(path, "required has to be an array of strings"), _failed;
+				_required.emplace_back(r.to_string().get(), r.to_string().size());
+			}
+		}
+		else if (key == "additionalProperties")
+		{
+			const int32_t _a = compile_node(value, path);
+			if (_a < json_schema_node::none)
+				return _failed;
+			_n.additional = _a;
+		}
+		else if (key == "items")
+			_items = &value;
+		else if (key == "prefixItems")
+			_prefix = &value;
+		else if (key == "additionalItems")
+			_additional_items = &value;
+		else if (!is_annotation(key))
+			return fail(path, "unsupported keyword"), _failed;
+	}
+
+	// the bounds, the stricter of minimum and exclusiveMinimum wins
+	if (_has_min)
+		_n.flags |= JSON_SCHEMA_MINIMUM | (_exclusive_min ? JSON_SCHEMA_EXCLUSIVE_MINIMUM : 0);
+	if (_has_xmin && (!_has_min || _xmin >= _n.minimum))
+	{
+		_n.minimum = _xmin;
+		_n.flags |= JSON_SCHEMA_MINIMUM | JSON_SCHEMA_EXCLUSIVE_MINIMUM;
+	}
+	if (_has_max)
+		_n.flags |= JSON_SCHEMA_MAXIMUM | (_exclusive_max ? JSON_SCHEMA_EXCLUSIVE_MAXIMUM : 0);
+	if (_has_xmax && (!_has_max || _xmax <= _n.maximum))
+	{
+		_n.maximum = _xmax;
+		_n.flags |= JSON_SCHEMA_MAXIMUM | JSON_SCHEMA_EXCLUSIVE_MAXIMUM;
+	}
+
+	// the elements: prefixItems or an array of items are positional, the
+	// rest follow items or additionalItems
+	const json_var *_rest = _items;
+	const json_var *_positional = _prefix;
+	if (_items != nullptr && _items->is_array())
+	{
+		_positional = _items;
+		_rest = _additional_items;
+	}
+	if (_positional != nullptr)
+	{
+		path.resize(_length);
+		json_append_pointer(path, _positional == _prefix ? "prefixItems" : "items");
+		if (!_positional->is_array())
+			return fail(path, "positional items have to be an array"), _failed;
+		std::vector<int32_t> _nodes;
+		const size_t _base = path.size();
+		for (size_t i = 0; i < _positional->to_array().count(); i++)
+		{
+			path.resize(_base);
+			json_append_pointer(path, std::to_string(i));
+			const int32_t _p = compile_node(_positional->to_array()[i], path);
+			if (_p < json_schema_node::none)
+				return _failed;
+			_nodes.push_back(_p);
+		}
+		_n.positional = (uint32_t)m_positional.size();
+		_n.positional_count = (uint32_t)_nodes.size();
+		m_positional.insert(m_positional.end(), _nodes.begin(), _nodes.end());
+	}
+	if (_rest != nullptr)
+	{
+		path.resize(_length);
+		json_append_pointer(path, _rest == _items ? "items" : "additionalItems");
+		_n.items = compile_node(*_rest, path);
+		if (_n.items < json_schema_node::none)
+			return _failed;
+	}
+
+	// the properties, required ones without a schema of their own included
+	std::vector<json_schema_property> _table;
+	for (const auto& [name, sub] : _properties)
+	{
+		path.resize(_length);
+		json_append_pointer(path, "properties");
+		json_append_pointer(path, name);
+		const int32_t _p = compile_node(*sub, path);
+		if (_p < json_schema_node::none)
+			return _failed;
+		_table.push_back({ hash_key(name), std::string(name), _p, false });
+	}
+	for (std::string_view name : _required)
+	{
+		auto _it = std::find_if(_table.begin(), _table.end(), [&](const json_schema_property& p) { return p.key == name; });
+		if (_it == _table.end())
+		{
+			_table.push_back({ hash_key(name), std::string(name), json_schema_node::any, true });
+			_n.required_count++;
+		}
+		else if (!_it->required)
+		{
+			_it->required = true;
+			_n.required_count++;
+		}
+	}
+	std::sort(_table.begin(), _table.end(), [](const json_schema_property& a, const json_schema_property& b)
+		{ return a.hash != b.hash ? a.hash < b.hash : a.key < b.key; });
+	_n.properties = (uint32_t)m_properties.size();
+	_n.property_count = (uint32_t)_table.size();
+	for (json_schema_property& p : _table)
+		m_properties.push_back(std::move(p));
+
+	path.resize(_length);
+	m_nodes[_index] = _n;
+	return _index;
+}
+
+bool json_schema::compile(const json_var& schema)
+{
+	m_nodes.clear();
+	m_properties.clear();
+	m_positional.clear();
+	m_enums.clear();
+	m_enum_hashes.clear();
+	m_patterns.clear();
+	m_error.clear();
+
+	// the boolean schemas get a node of their own at the root
+	std::string _path;
+	if (schema.is_boolean())
+	{
+		m_nodes.emplace_back();
+		if (!schema.to_boolean())
+			m_nodes[0].types = 0;
+		return true;
+	}
+	if (compile_node(schema, _path) < 0)
+	{
+		m_nodes.clear();
+		return false;
+	}
+	for (const json_var& v : m_enums)
+		m_enum_hashes.push_back(json_hash(v));
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// checks
+//////////////////////////////////////////////////////////////////////////
+
+int32_t json_schema::member(int32_t node, std::string_view key, int32_t& index) const
+{
+	const json_schema_node& _n = m_nodes[node];
+	index = -1;
+	if (_n.property_count > 0)
+	{
+		const uint64_t _hash = hash_key(key);
+		auto _first = m_properties.begin() + _n.properties;
+		auto _last = _first + _n.property_count;
+		auto _it = std::lower_bound(_first, _last, _hash, [](const json_schema_property& p, uint64_t h) { return p.hash < h; });
+		for (; _it != _last && _it->hash == _hash; ++_it)
+			if (_it->key == key)
+			{
+				index = (int32_t)(_it - m_properties.begin());
+				return _it->node;
+			}
+	}
+	return _n.additional;
+}
+
+int32_t json_schema::element(int32_t node, size_t index) const
+{
+	const json_schema_node& _n = m_nodes[node];
+	if (index < _n.positional_count)
+		return m_positional[_n.positional + index];
+	return _n.items;
+}
+
+json_schema_error json_schema::check_type(const json_schema_node& node, const json_var& var) const
+{
+	if (node.types & type_bit(var.type))
+		return json_schema_error::none;
+	if (var.is_number() && (node.types & JSON_SCHEMA_INTEGER))
+	{
+		const double _n = var.to_double();
+		if (std::isfinite(_n) && _n == std::floor(_n))
+			return json_schema_error::none;
+	}
+	return node.types == 0 ? json_schema_error::rejected : json_schema_error::type;
+}
+
+json_schema_error json_schema::check_number(const json_schema_node& node, double n) const
+{
+	if (node.flags & JSON_SCHEMA_MINIMUM)
+	{
+		if ((node.flags & JSON_SCHEMA_EXCLUSIVE_MINIMUM) ? !(n > node.minimum) : !(n >= node.minimum))
+			return json_schema_error::minimum;
+	}
+	if (node.flags & JSON_SCHEMA_MAXIMUM)
+	{
+		if ((node.flags & JSON_SCHEMA_EXCLUSIVE_MAXIMUM) ? !(n < node.maximum) : !(n <= node.maximum))
+			return json_schema_error::maximum;
+	}
+	// a quotient within rounding of an integer is a multiple
+	if (node.flags & JSON_SCHEMA_MULTIPLE_OF)
+	{
+		const double _q = n / node.multiple_of;
+		if (!std::isfinite(_q) || std::fabs(_q - std::round(_q)) > 1e-9 * std::max(1.0, std::fabs(_q)))
+			return json_schema_error::multiple_of;
+	}
+	return json_schema_error::none;
+}
+
+json_schema_error json_schema::check_counts(const json_schema_node& node, bool object, size_t count) const
+{
+	if (object)
+	{
+		if (count < node.min_properties)
+			return json_schema_error::min_properties;
+		if (count > node.max_properties)
+			return json_schema_error::max_properties;
+	}
+	else
+	{
+		if (count < node.min_items)
+			return json_schema_error::min_items;
+		if (count > node.max_items)
+			return json_schema_error::max_items;
+	}
+	return json_schema_error::none;
+}
+
+// everything but what is under a container
+json_schema_error json_schema::check_value(const json_schema_node& node, const json_var& var) const
+{
+	json_schema_error _e = check_type(node, var);
+	if (_e != json_schema_error::none)
+		return _e;
+
+	if (var.is_number())
+		_e = check_number(node, var.to_double());
+	else if (var.is_string())
+	{
+		const json_string& _str = var.to_string();
+		if (node.min_length > 0 || node.max_length != SIZE_MAX)
+		{
+			// the length is in code points, continuation bytes do not count
+			size_t _length = 0;
+			for (size_t i = 0; i < _str.size(); i++)
+				_length += ((uint8_t)_str.get()[i] & 0xc0) != 0x80;
+			if (_length < node.min_length)
+				return json_schema_error::min_length;
+			if (_length > node.max_length)
+				return json_schema_error::max_length;
+		}
+		if (node.pattern >= 0 && !m_patterns[node.pattern].search(_str.get(), _str.size()))
+			return json_schema_error::pattern;
+	}
+	else if (var.is_object())
+		_e = check_counts(node, true, var.to_object().count());
+	else if (var.is_array())
+		_e = check_counts(node, false, var.to_array().count());
+	if (_e != json_schema_error::none)
+		return _e;
+
+	return check_enum(node, var);
+}
+
+json_schema_error json_schema::check_enum(const json_schema_node& node, const json_var& var) const
+{
+	if (node.enum_count == 0)
+		return json_schema_error::none;
+	const uint64_t _hash = json_hash(var);
+	for (uint32_t i = node.enums; i < node.enums + node.enum_count; i++)
+		if (m_enum_hashes[i] == _hash && m_enums[i] == var)
+			return json_schema_error::none;
+	return json_schema_error::enumeration;
+}
+
+// an element of a packed array, a number
+json_schema_error json_schema::check_packed(const json_schema_node& node, const json_array& arr, size_t index) const
+{
+	const double n = arr.to_double(index);
+	if (!(node.types & type_bit(json_type::number)) && !((node.types & JSON_SCHEMA_INTEGER) && n == std::floor(n)))
+		return node.types == 0 ? json_schema_error::rejected : json_schema_error::type;
+	json_schema_error _e = check_number(node, n);
+	if (_e != json_schema_error::none || node.enum_count == 0)
+		return _e;
+	// the enum values are compared with the exact number, int64_t and
+	// double ones go through their shortest text
+	if (arr.packed_type() == json_packed_type::float32)
+		return check_enum(node, json_var(arr.floats()[index]));
+	char _text[32];
+	const std::to_chars_result _r = arr.packed_type() == json_packed_type::int64
+		? std::to_chars(_text, _text + sizeof(_text), arr.integers()[index])
+		: std::to_chars(_text, _text + sizeof(_text), arr.doubles()[index]);
+	return check_enum(node, json_var(json_number_text(_text, (size_t)(_r.ptr - _text))));
+}
+
+// the path is built on the way back, only when the value does not match.
+// the depth of the recursion is bounded by the depth of the schema.
+json_schema_error json_schema::check(int32_t node, const json_var& var, json_schema_result& result) const
+{
+	if (node == json_schema_node::any)
+		return json_schema_error::none;
+	if (node == json_schema_node::none)
+		return result.code = json_schema_error::rejected;
+
+	const json_schema_node& _n = m_nodes[node];
+	json_schema_error _e = check_value(_n, var);
+	if (_e != json_schema_error::none)
+		return result.code = _e;
+
+	if (var.is_object() && (_n.property_count > 0 || _n.additional != json_schema_node::any))
+	{
+		uint32_t _required = 0;
+		for (const auto& [key, value] : var.to_object())
+		{
+			int32_t _property;
+			const int32_t _child = member(node, key, _property);
+			if (_property >= 0 && m_properties[_property].required)
+				_required++;
+			if (_child == json_schema_node::none && _property < 0)
+				result.code = json_schema_error::additional_property;
+			else if (check(_child, value, result) == json_schema_error::none)
+				continue;
+			std::string _path;
+			json_append_pointer(_path, key);
+			result.path.insert(0, _path);
+			return result.code;
+		}
+		if (_required < _n.required_count)
+		{
+			for (uint32_t i = _n.properties; i < _n.properties + _n.property_count; i++)
+				if (m_properties[i].required && !var.to_object().has(m_properties[i].key))
+				{
+					json_append_pointer(result.path, m_properties[i].key);
+					break;
+				}
+			return result.code = json_schema_error::required;
+		}
+	}
+	else if (var.is_array() && (_n.items != json_schema_node::any || _n.positional_count > 0))
+	{
+		const json_array& _arr = var.to_array();
+		for (size_t i = 0; i < _arr.count(); i++)
+		{
+			const int32_t _child = element(node, i);
+			if (_child == json_schema_node::any)
+				continue;
+			// packed numbers are checked without making their elements
+			if (!_arr.is_packed())
+				_e = check(_child, _arr[i], result);
+			else if (_child == json_schema_node::none)
+				_e = result.code = json_schema_error::rejected;
+			else
+				_e = result.code = check_packed(m_nodes[_child], _arr, i);
+			if (_e != json_schema_error::none)
+			{
+				result.path.insert(0, "/" + std::to_string(i));
+				return _e;
+			}
+		}
+	}
+	return json_schema_error::none;
+}
+
+json_schema_result json_schema::validate(const json_var& var) const
+{
+	json_schema_result _result;
+	if (m_nodes.empty())
+		_result.code = json_schema_error::rejected;
+	else
+		check(0, var, _result);
+	return _result;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_schema_result
+//////////////////////////////////////////////////////////////////////////
+
+const char* json_schema_error_string(json_schema_error code)
+{
+	switch (code)
+	{
+	case json_schema_error::none:					return "no error";
+	case json_schema_error::not_parsed:				return "the document does not parse";
+	case json_schema_error::rejected:				return "no value is allowed";
+	case json_schema_error::type:					return "wrong type";
+	case json_schema_error::enumeration:			return "not one of the allowed values";
+	case json_schema_error::minimum:				return "below the minimum";
+	case json_schema_error::maximum:				return "above the maximum";
+	case json_schema_error::multiple_of:			return "not a multiple";
+	case json_schema_error::min_length:				return "string too short";
+	case json_schema_error::max_length:				return "string too long";
+	case json_schema_error::pattern:				return "string does not match the pattern";
+	case json_schema_error::min_items:				return "too few elements";
+	case json_schema_error::max_items:				return "too many elements";
+	case json_schema_error::min_properties:			return "too few members";
+	case json_schema_error::max_properties:			return "too many members";
+	case json_schema_error::required:				return "missing required member";
+	case json_schema_error::additional_property:	return "member not allowed";
+	}
+	return "unknown error";
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_stats.h>
+
+#if defined(JSON_ENABLE_STATS)
+thread_local json_stats *g_json_stats = nullptr;
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+//	json_stats
+//////////////////////////////////////////////////////////////////////////
+
+size_t json_stats::node_count() const
+{
+	size_t _n = 0;
+	for (size_t n : nodes)
+		_n += n;
+	return _n;
+}
+
+void json_stats::reset()
+{
+	*this = json_stats();
+}
+
+std::ostream& operator<<(std::ostream& stream, const json_stats& stats)
+{
+	stream << "bytes : " << stats.bytes << "\n";
+	stream << "tokens : " << stats.tokens << "\n";
+	stream << "nodes : " << stats.node_count()
+		<< " (null " << stats.nodes[(size_t)json_type::null]
+		<< ", object " << stats.nodes[(size_t)json_type::object]
+		<< ", array " << stats.nodes[(size_t)json_type::array]
+		<< ", string " << stats.nodes[(size_t)json_type::string]
+		<< ", boolean " << stats.nodes[(size_t)json_type::boolean]
+		<< ", number " << stats.nodes[(size_t)json_type::number] << ")\n";
+	stream << "allocations : " << stats.allocations << " (" << stats.allocated_bytes << " bytes)\n";
+	stream << "max depth : " << stats.max_depth << "\n";
+	stream << "lexical analysis : " << stats.lexical_ns << " ns\n";
+	stream << "syntax analysis : " << stats.syntax_ns << " ns\n";
+	stream << "write : " << stats.write_ns << " ns\n";
+	return stream;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_stats_scope
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(JSON_ENABLE_STATS)
+
+json_stats_scope::json_stats_scope(json_stats& stats)
+{
+	m_previous = g_json_stats;
+	g_json_stats = &stats;
+}
+
+json_stats_scope::~json_stats_scope()
+{
+	g_json_stats = m_previous;
+}
+
+#else
+
+json_stats_scope::json_stats_scope(json_stats& stats)
+{
+	m_previous = nullptr;
+}
+
+json_stats_scope::~json_stats_scope()
+{
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,389 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_stream_writer.h>
+#include <json/json_escape.h>
+#include <charconv>
+#include <cmath>
+
+#if defined(JSON_PLATFORM_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+static bool write_fd(int fd, const char *data, size_t size)
+{
+	while (size > 0)
+	{
+#if defined(JSON_PLATFORM_WIN)
+		int n = _write(fd, data, (unsigned int)std::min<size_t>(size, 1 << 30));
+#else
+		ssize_t n = ::write(fd, data, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+#endif
+		if (n <= 0)
+			return false;
+		data += n;
+		size -= (size_t)n;
+	}
+	return true;
+}
+
+template<typename T>
+static void append_number(std::string& out, T v)
+{
+	char _buffer[32];
+	std::to_chars_result _r = std::to_chars(_buffer, _buffer + sizeof(_buffer), v);
+	out.append(_buffer, (size_t)(_r.ptr - _buffer));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_stream_writer
+//////////////////////////////////////////////////////////////////////////
+
+json_stream_writer::json_stream_writer(std::string& out)
+	: m_out(&out), m_stream(nullptr), m_fd(-1), m_flush_size(0), m_roots(0), m_failed(false), m_after_key(false)
+{
+}
+
+json_stream_writer::json_stream_writer(std::ostream& stream, size_t buffer_size)
+	: m_out(&m_buffer), m_stream(&stream), m_fd(-1), m_flush_size(buffer_size), m_roots(0), m_failed(false), m_after_key(false)
+{
+	m_buffer.reserve(buffer_size);
+}
+
+json_stream_writer::json_stream_writer(int fd, size_t buffer_size)
+	: m_out(&m_buffer), m_stream(nullptr), m_fd(fd), m_flush_size(buffer_size), m_roots(0), m_failed(false), m_after_key(false)
+{
+	m_buffer.reserve(buffer_size);
+}
+
+json_stream_writer::~json_stream_writer()
+{
+	flush();
+}
+
+bool json_stream_writer::flush()
+{
+	if (m_out != &m_buffer || m_buffer.empty())
+		return !m_failed;
+
+	if (!m_failed)
+	{
+		if (m_stream != nullptr)
+			m_failed = !m_stream->write(m_buffer.data(), (std::streamsize)m_buffer.size());
+		else
+			m_failed = !write_fd(m_fd, m_buffer.data(), m_buffer.size());
+	}
+	m_buffer.clear();
+	return !m_failed;
+}
+
+// writes what goes before a value: a newline between top level values, a
+// comma between the elements of an array. in an object the key did that
+void json_stream_writer::separate()
+{
+	if (m_stack.empty())
+	{
+		if (m_roots++ > 0)
+			*m_out += '\n';
+		return;
+	}
+
+	uint8_t& _top = m_stack.back();
+	if (_top & in_object)
+	{
+#if defined(JSON_ENABLE_ASSERT)
+		JSON_ASSERT(m_after_key, "json_stream_writer : value in an object without a key");
+		m_after_key = false;
+#endif
+		return;
+	}
+
+	if (_top & has_member)
+		*m_out += ',';
+	_top |= has_member;
+}
+
+void json_stream_writer::end(bool object)
+{
+	JSON_ASSERT(!m_stack.empty(), "json_stream_writer : end without a begin");
+	JSON_ASSERT((bool)(m_stack.back() & in_object) == object, "json_stream_writer : end does not match its begin");
+#if defined(JSON_ENABLE_ASSERT)
+	JSON_ASSERT(!m_after_key, "json_stream_writer : key without a value");
+#endif
+	m_stack.pop_back();
+	*m_out += object ? '}' : ']';
+	done();
+}
+
+json_stream_writer& json_stream_writer::begin_object()
+{
+	separate();
+	m_stack.push_back(in_object);
+	*m_out += '{';
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::end_object()
+{
+	end(true);
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::begin_array()
+{
+	separate();
+	m_stack.push_back(0);
+	*m_out += '[';
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::end_array()
+{
+	end(false);
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::key(std::string_view k)
+{
+	JSON_ASSERT(!m_stack.empty() && (m_stack.back() & in_object), "json_stream_writer : key outside of an object");
+#if defined(JSON_ENABLE_ASSERT)
+	JSON_ASSERT(!m_after_key, "json_stream_writer : key without a value");
+	m_after_key = true;
+#endif
+	uint8_t& _top = m_stack.back();
+	if (_top & has_member)
+		*m_out += ',';
+	_top |= has_member;
+	json_append_string(*m_out, k.data(), k.size());
+	*m_out += ':';
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::value(std::string_view v)
+{
+	separate();
+	json_append_string(*m_out, v.data(), v.size());
+	done();
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::value(const char *v)
+{
+	return value(std::string_view(v));
+}
+
+// JSON has no representation for infinities and NaN, they are written as null
+json_stream_writer& json_stream_writer::value(double v)
+{
+	separate();
+	if (std::isfinite(v))
+		append_number(*m_out, v);
+	else
+		m_out->append("null");
+	done();
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::value(float v)
+{
+	separate();
+	if (std::isfinite(v))
+		append_number(*m_out, v);
+	else
+		m_out->append("null");
+	done();
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::value(bool v)
+{
+	separate();
+	m_out->append(v ? "true" : "false");
+	done();
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::value(std::nullptr_t)
+{
+	separate();
+	m_out->append("null");
+	done();
+	return *this;
+}
+
+json_stream_writer& json_stream_writer::value(const json_var& v)
+{
+	separate();
+	write(v);
+	done();
+	return *this;
+}
+
+void json_stream_writer::integer(int64_t v)
+{
+	separate();
+	append_number(*m_out, v);
+	done();
+}
+
+void json_stream_writer::unsigned_integer(uint64_t v)
+{
+	separate();
+	append_number(*m_out, v);
+	done();
+}
+
+// a scalar, or the opening bracket of a container
+static inline void write_open(std::string& out, const json_var& var)
+{
+	switch (var.type)
+	{
+	case json_type::null:
+		out.append("null");
+		break;
+	case json_type::boolean:
+		out.append(var.value.boolean ? "true" : "false");
+		break;
+	case json_type::number:
+		if (var.lazy)
+			out.append(var.value.text->text());
+		else if (std::isfinite(var.value.number))
+			append_number(out, var.value.number);
+		else
+			out.append("null");
+		break;
+	case json_type::string:
+		json_append_string(out, var.value.string->get(), var.value.string->size());
+		break;
+	case json_type::array:
+		out += '[';
+		break;
+	case json_type::object:
+		out += '{';
+		break;
+	}
+}
+
+// the elements of a packed array, read straight from its numbers
+static void append_packed(std::string& out, const json_array& arr)
+{
+	bool _first = true;
+	switch (arr.packed_type())
+	{
+	case json_packed_type::float32:
+		for (float n : arr.floats())
+		{
+			if (!_first)
+				out += ',';
+			_first = false;
+			if (std::isfinite(n))
+				append_number(out, n);
+			else
+				out.append("null");
+		}
+		break;
+	case json_packed_type::float64:
+		for (double n : arr.doubles())
+		{
+			if (!_first)
+				out += ',';
+			_first = false;
+			if (std::isfinite(n))
+				append_number(out, n);
+			else
+				out.append("null");
+		}
+		break;
+	default:
+		for (int64_t n : arr.integers())
+		{
+			if (!_first)
+				out += ',';
+			_first = false;
+			append_number(out, n);
+		}
+		break;
+	}
+}
+
+// the open containers are kept on a stack of their own, not on the native
+// stack, so a tree of any depth can be written
+void json_stream_writer::write(const json_var& var)
+{
+	struct frame
+	{
+		const json_var *var;
+		size_t index;
+	};
+	std::vector<frame> _stack;
+
+	write_open(*m_out, var);
+	if (var.is_array() || var.is_object())
+		_stack.push_back({ &var, 0 });
+
+	while (!_stack.empty())
+	{
+		frame& _f = _stack.back();
+		const bool _object = _f.var->is_object();
+		if (!_object && _f.var->value.array->is_packed())
+		{
+			append_packed(*m_out, *_f.var->value.array);
+			*m_out += ']';
+			_stack.pop_back();
+			continue;
+		}
+		const size_t _count = _object ? _f.var->value.object->count() : _f.var->value.array->count();
+		if (_f.index == _count)
+		{
+			*m_out += _object ? '}' : ']';
+			_stack.pop_back();
+			continue;
+		}
+
+		const size_t i = _f.index++;
+		if (i > 0)
+			*m_out += ',';
+		const json_var *_child;
+		if (_object)
+		{
+			const json_object& _obj = *_f.var->value.object;
+			const json_key& _key = _obj.get_key(i);
+			json_append_string(*m_out, _key.data(), _key.size());
+			*m_out += ':';
+			_child = &_obj[i];
+		}
+		else
+			_child = &_f.var->to_array()[i];
+
+		write_open(*m_out, *_child);
+		if (_child->is_array() || _child->is_object())
+			_stack.push_back({ _child, 0 });
+	}
+}
\ No newline at end of file
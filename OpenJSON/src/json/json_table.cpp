@@ -0,0 +1,734 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_table.h>
+
+#include <bit>
+#include <cmath>
+#include <unordered_map>
+
+#if defined(JSON_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(JSON_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+// the bits of the rows of a word of a bitmap, the last word is partial
+static inline uint64_t word_mask(size_t rows, size_t word)
+{
+	const size_t _n = rows - word * 64;
+	return _n >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << _n) - 1;
+}
+
+template <json_compare OP, typename T>
+static inline bool compare(T a, T b)
+{
+	if constexpr (OP == json_compare::equal)			return a == b;
+	else if constexpr (OP == json_compare::not_equal)	return a != b;
+	else if constexpr (OP == json_compare::less)		return a < b;
+	else if constexpr (OP == json_compare::less_equal)	return a <= b;
+	else if constexpr (OP == json_compare::greater)		return a > b;
+	else												return a >= b;
+}
+
+// calls f.template operator()<op>(), turning the operator into a constant
+template <typename F>
+static inline void dispatch(json_compare op, F&& f)
+{
+	switch (op)
+	{
+	case json_compare::equal:			f.template operator()<json_compare::equal>(); break;
+	case json_compare::not_equal:		f.template operator()<json_compare::not_equal>(); break;
+	case json_compare::less:			f.template operator()<json_compare::less>(); break;
+	case json_compare::less_equal:		f.template operator()<json_compare::less_equal>(); break;
+	case json_compare::greater:			f.template operator()<json_compare::greater>(); break;
+	case json_compare::greater_equal:	f.template operator()<json_compare::greater_equal>(); break;
+	}
+}
+
+// calls run(first, count) for the runs of 64 rows that are all counted and
+// row(index) for the others, rows that are null or not selected are skipped
+template <typename R, typename B>
+static void for_each_row(const json_bitmap& valid, const json_bitmap *selection, size_t rows, R run, B row)
+{
+	const uint64_t *_valid = valid.words();
+	const uint64_t *_selected = selection != nullptr ? selection->words() : nullptr;
+	for (size_t w = 0; w < valid.word_count(); w++)
+	{
+		uint64_t _mask = _valid[w];
+		if (_selected != nullptr)
+			_mask &= _selected[w];
+		const size_t _base = w * 64;
+		if (_mask == word_mask(rows, w))
+		{
+			run(_base, rows - _base < 64 ? rows - _base : 64);
+			continue;
+		}
+		while (_mask != 0)
+		{
+			row(_base + (size_t)std::countr_zero(_mask));
+			_mask &= _mask - 1;
+		}
+	}
+}
+
+// keeps the selected rows that are not null and for which match(first, count)
+// sets the bit, match is only called for words with a row still selected
+template <typename M>
+static void narrow(const json_bitmap& valid, json_bitmap& selection, M match)
+{
+	JSON_ASSERT(selection.size() == valid.size(), "json_column : the selection is not the size of the column");
+	const uint64_t *_valid = valid.words();
+	uint64_t *_selected = selection.words();
+	const size_t _rows = valid.size();
+	for (size_t w = 0; w < valid.word_count(); w++)
+	{
+		_selected[w] &= _valid[w];
+		if (_selected[w] == 0)
+			continue;
+		const size_t _base = w * 64;
+		_selected[w] &= match(_base, _rows - _base < 64 ? _rows - _base : 64);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// kernels
+//////////////////////////////////////////////////////////////////////////
+
+static double sum_run(const double *p, size_t n)
+{
+	size_t i = 0;
+	double _sum = 0.0;
+#if defined(JSON_SIMD_SSE2)
+	__m128d _a = _mm_setzero_pd(), _b = _mm_setzero_pd();
+	for (; i + 4 <= n; i += 4)
+	{
+		_a = _mm_add_pd(_a, _mm_loadu_pd(p + i));
+		_b = _mm_add_pd(_b, _mm_loadu_pd(p + i + 2));
+	}
+	double _lanes[2];
+	_mm_storeu_pd(_lanes, _mm_add_pd(_a, _b));
+	_sum = _lanes[0] + _lanes[1];
+#elif defined(JSON_SIMD_NEON)
+	float64x2_t _a = vdupq_n_f64(0.0), _b = vdupq_n_f64(0.0);
+	for (; i + 4 <= n; i += 4)
+	{
+		_a = vaddq_f64(_a, vld1q_f64(p + i));
+		_b = vaddq_f64(_b, vld1q_f64(p + i + 2));
+	}
+	_sum = vaddvq_f64(vaddq_f64(_a, _b));
+#endif
+	for (; i < n; i++)
+		_sum += p[i];
+	return _sum;
+}
+
+// n is never 0
+template <bool MIN>
+static double bound_run(const double *p, size_t n)
+{
+	size_t i = 0;
+	double _bound = p[0];
+#if defined(JSON_SIMD_SSE2)
+	if (n >= 2)
+	{
+		__m128d _a = _mm_set1_pd(p[0]);
+		for (; i + 2 <= n; i += 2)
+			_a = MIN ? _mm_min_pd(_a, _mm_loadu_pd(p + i)) : _mm_max_pd(_a, _mm_loadu_pd(p + i));
+		double _lanes[2];
+		_mm_storeu_pd(_lanes, _a);
+		_bound = MIN ? std::fmin(_lanes[0], _lanes[1]) : std::fmax(_lanes[0], _lanes[1]);
+	}
+#elif defined(JSON_SIMD_NEON)
+	if (n >= 2)
+	{
+		float64x2_t _a = vdupq_n_f64(p[0]);
+		for (; i + 2 <= n; i += 2)
+			_a = MIN ? vminq_f64(_a, vld1q_f64(p + i)) : vmaxq_f64(_a, vld1q_f64(p + i));
+		_bound = MIN ? vminvq_f64(_a) : vmaxvq_f64(_a);
+	}
+#endif
+	for (; i < n; i++)
+		_bound = MIN ? (p[i] < _bound ? p[i] : _bound) : (p[i] > _bound ? p[i] : _bound);
+	return _bound;
+}
+
+// the floats are added as doubles, as json_array::to_double reads them
+static double sum_run(const float *p, size_t n)
+{
+	size_t i = 0;
+	double _sum = 0.0;
+#if defined(JSON_SIMD_SSE2)
+	__m128d _a = _mm_setzero_pd(), _b = _mm_setzero_pd();
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128 _x = _mm_loadu_ps(p + i);
+		_a = _mm_add_pd(_a, _mm_cvtps_pd(_x));
+		_b = _mm_add_pd(_b, _mm_cvtps_pd(_mm_movehl_ps(_x, _x)));
+	}
+	double _lanes[2];
+	_mm_storeu_pd(_lanes, _mm_add_pd(_a, _b));
+	_sum = _lanes[0] + _lanes[1];
+#elif defined(JSON_SIMD_NEON)
+	float64x2_t _a = vdupq_n_f64(0.0), _b = vdupq_n_f64(0.0);
+	for (; i + 4 <= n; i += 4)
+	{
+		const float32x4_t _x = vld1q_f32(p + i);
+		_a = vaddq_f64(_a, vcvt_f64_f32(vget_low_f32(_x)));
+		_b = vaddq_f64(_b, vcvt_high_f64_f32(_x));
+	}
+	_sum = vaddvq_f64(vaddq_f64(_a, _b));
+#endif
+	for (; i < n; i++)
+		_sum += p[i];
+	return _sum;
+}
+
+// n is never 0
+template <bool MIN>
+static double bound_run(const float *p, size_t n)
+{
+	size_t i = 0;
+	float _bound = p[0];
+#if defined(JSON_SIMD_SSE2)
+	if (n >= 4)
+	{
+		__m128 _a = _mm_set1_ps(p[0]);
+		for (; i + 4 <= n; i += 4)
+			_a = MIN ? _mm_min_ps(_a, _mm_loadu_ps(p + i)) : _mm_max_ps(_a, _mm_loadu_ps(p + i));
+		float _lanes[4];
+		_mm_storeu_ps(_lanes, _a);
+		_bound = MIN ? std::fmin(std::fmin(_lanes[0], _lanes[1]), std::fmin(_lanes[2], _lanes[3]))
+			: std::fmax(std::fmax(_lanes[0], _lanes[1]), std::fmax(_lanes[2], _lanes[3]));
+	}
+#elif defined(JSON_SIMD_NEON)
+	if (n >= 4)
+	{
+		float32x4_t _a = vdupq_n_f32(p[0]);
+		for (; i + 4 <= n; i += 4)
+			_a = MIN ? vminq_f32(_a, vld1q_f32(p + i)) : vmaxq_f32(_a, vld1q_f32(p + i));
+		_bound = MIN ? vminvq_f32(_a) : vmaxvq_f32(_a);
+	}
+#endif
+	for (; i < n; i++)
+		_bound = MIN ? (p[i] < _bound ? p[i] : _bound) : (p[i] > _bound ? p[i] : _bound);
+	return _bound;
+}
+
+// sse2 and neon have no 64 bit integer min and max, plain loops the
+// compiler can still unroll
+static int64_t sum_run(const int64_t *p, size_t n)
+{
+	int64_t _sum = 0;
+	for (size_t i = 0; i < n; i++)
+		_sum += p[i];
+	return _sum;
+}
+
+// n is never 0
+template <bool MIN>
+static int64_t bound_run(const int64_t *p, size_t n)
+{
+	int64_t _bound = p[0];
+	for (size_t i = 1; i < n; i++)
+		_bound = MIN ? (p[i] < _bound ? p[i] : _bound) : (p[i] > _bound ? p[i] : _bound);
+	return _bound;
+}
+
+// the kernels for the packed arrays, see json_array::sum
+double json_sum_run(const float *p, size_t n) { return sum_run(p, n); }
+double json_sum_run(const double *p, size_t n) { return sum_run(p, n); }
+double json_sum_run(const int64_t *p, size_t n) { return (double)sum_run(p, n); }
+double json_min_run(const float *p, size_t n) { return bound_run<true>(p, n); }
+double json_min_run(const double *p, size_t n) { return bound_run<true>(p, n); }
+double json_min_run(const int64_t *p, size_t n) { return (double)bound_run<true>(p, n); }
+double json_max_run(const float *p, size_t n) { return bound_run<false>(p, n); }
+double json_max_run(const double *p, size_t n) { return bound_run<false>(p, n); }
+double json_max_run(const int64_t *p, size_t n) { return (double)bound_run<false>(p, n); }
+
+template <json_compare OP>
+static uint64_t match_numbers(const double *p, size_t n, double value)
+{
+	size_t i = 0;
+	uint64_t _bits = 0;
+#if defined(JSON_SIMD_SSE2)
+	const __m128d _v = _mm_set1_pd(value);
+	for (; i + 2 <= n; i += 2)
+	{
+		const __m128d _a = _mm_loadu_pd(p + i);
+		__m128d _m;
+		if constexpr (OP == json_compare::equal)			_m = _mm_cmpeq_pd(_a, _v);
+		else if constexpr (OP == json_compare::not_equal)	_m = _mm_cmpneq_pd(_a, _v);
+		else if constexpr (OP == json_compare::less)		_m = _mm_cmplt_pd(_a, _v);
+		else if constexpr (OP == json_compare::less_equal)	_m = _mm_cmple_pd(_a, _v);
+		else if constexpr (OP == json_compare::greater)		_m = _mm_cmpgt_pd(_a, _v);
+		else												_m = _mm_cmpge_pd(_a, _v);
+		_bits |= (uint64_t)_mm_movemask_pd(_m) << i;
+	}
+#elif defined(JSON_SIMD_NEON)
+	const float64x2_t _v = vdupq_n_f64(value);
+	for (; i + 2 <= n; i += 2)
+	{
+		const float64x2_t _a = vld1q_f64(p + i);
+		uint64x2_t _m;
+		if constexpr (OP == json_compare::equal)			_m = vceqq_f64(_a, _v);
+		else if constexpr (OP == json_compare::not_equal)	_m = veorq_u64(vceqq_f64(_a, _v), vdupq_n_u64(~(uint64_t)0));
+		else if constexpr (OP == json_compare::less)		_m = vcltq_f64(_a, _v);
+		else if constexpr (OP == json_compare::less_equal)	_m = vcleq_f64(_a, _v);
+		else if constexpr (OP == json_compare::greater)		_m = vcgtq_f64(_a, _v);
+		else												_m = vcgeq_f64(_a, _v);
+		_bits |= ((vgetq_lane_u64(_m, 0) & 1) | (vgetq_lane_u64(_m, 1) & 2)) << i;
+	}
+#endif
+	for (; i < n; i++)
+		_bits |= (uint64_t)compare<OP>(p[i], value) << i;
+	return _bits;
+}
+
+static uint64_t match_code(const uint32_t *p, size_t n, uint32_t code)
+{
+	size_t i = 0;
+	uint64_t _bits = 0;
+#if defined(JSON_SIMD_SSE2)
+	const __m128i _c = _mm_set1_epi32((int)code);
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i _m = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(p + i)), _c);
+		_bits |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_m)) << i;
+	}
+#elif defined(JSON_SIMD_NEON)
+	const uint32x4_t _c = vdupq_n_u32(code);
+	const uint32x4_t _weights = { 1, 2, 4, 8 };
+	for (; i + 4 <= n; i += 4)
+	{
+		const uint32x4_t _m = vceqq_u32(vld1q_u32(p + i), _c);
+		_bits |= (uint64_t)vaddvq_u32(vandq_u32(_m, _weights)) << i;
+	}
+#endif
+	for (; i < n; i++)
+		_bits |= (uint64_t)(p[i] == code) << i;
+	return _bits;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_bitmap
+//////////////////////////////////////////////////////////////////////////
+
+json_bitmap::json_bitmap(size_t size, bool value)
+	: m_words((size + 63) / 64, value ? ~(uint64_t)0 : 0), m_size(size)
+{
+	if (value && (size & 63) != 0)
+		m_words.back() = word_mask(size, m_words.size() - 1);
+}
+
+size_t json_bitmap::count() const
+{
+	size_t _count = 0;
+	for (uint64_t w : m_words)
+		_count += (size_t)std::popcount(w);
+	return _count;
+}
+
+json_bitmap& json_bitmap::operator&=(const json_bitmap& other)
+{
+	JSON_ASSERT(m_size == other.m_size, "json_bitmap : sizes differ");
+	for (size_t i = 0; i < m_words.size(); i++)
+		m_words[i] &= other.m_words[i];
+	return *this;
+}
+
+json_bitmap& json_bitmap::operator|=(const json_bitmap& other)
+{
+	JSON_ASSERT(m_size == other.m_size, "json_bitmap : sizes differ");
+	for (size_t i = 0; i < m_words.size(); i++)
+		m_words[i] |= other.m_words[i];
+	return *this;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_column
+//////////////////////////////////////////////////////////////////////////
+
+json_var json_column::get(size_t row) const
+{
+	JSON_ASSERT(row < m_rows, "json_column : row out of range");
+	if (is_null(row))
+		return json_var();
+	switch (m_type)
+	{
+	case json_column_type::number:	return json_var((json_number)m_numbers[row]);
+	case json_column_type::integer:	return json_var((json_number)m_integers[row]);
+	case json_column_type::boolean:	return json_var((json_boolean)(m_booleans[row] != 0));
+	case json_column_type::string:	return json_var(std::string_view(m_dictionary[m_codes[row]]));
+	case json_column_type::variant:	return m_vars[row];
+	default:						return json_var();
+	}
+}
+
+double json_column::number(size_t row) const
+{
+	JSON_ASSERT(row < m_rows, "json_column : row out of range");
+	JSON_ASSERT(m_type == json_column_type::number || m_type == json_column_type::integer, "json_column : not a number column");
+	return m_type == json_column_type::integer ? (double)m_integers[row] : m_numbers[row];
+}
+
+std::string_view json_column::string(size_t row) const
+{
+	JSON_ASSERT(row < m_rows, "json_column : row out of range");
+	JSON_ASSERT(m_type == json_column_type::string, "json_column : not a string column");
+	return is_null(row) ? std::string_view() : std::string_view(m_dictionary[m_codes[row]]);
+}
+
+double json_column::sum(const json_bitmap *selection) const
+{
+	if (m_type == json_column_type::number)
+	{
+		// null rows hold 0, without a selection every row can be added
+		if (selection == nullptr)
+			return sum_run(m_numbers.data(), m_rows);
+		double _sum = 0.0;
+		for_each_row(m_valid, selection, m_rows,
+			[&](size_t first, size_t count) { _sum += sum_run(m_numbers.data() + first, count); },
+			[&](size_t row) { _sum += m_numbers[row]; });
+		return _sum;
+	}
+	if (m_type == json_column_type::integer)
+	{
+		if (selection == nullptr)
+			return (double)sum_run(m_integers.data(), m_rows);
+		int64_t _sum = 0;
+		for_each_row(m_valid, selection, m_rows,
+			[&](size_t first, size_t count) { _sum += sum_run(m_integers.data() + first, count); },
+			[&](size_t row) { _sum += m_integers[row]; });
+		return (double)_sum;
+	}
+	JSON_ASSERT(m_type == json_column_type::null, "json_column : not a number column");
+	return 0.0;
+}
+
+template <bool MIN>
+static std::optional<double> bound(const json_column& column, const json_bitmap *selection)
+{
+	bool _found = false;
+	double _bound = 0.0;
+	auto _add = [&](double value)
+	{
+		if (!_found || (MIN ? value < _bound : value > _bound))
+			_bound = value;
+		_found = true;
+	};
+
+	if (column.type() == json_column_type::number)
+	{
+		const double *_numbers = column.numbers();
+		for_each_row(column.valid(), selection, column.size(),
+			[&](size_t first, size_t count) { _add(bound_run<MIN>(_numbers + first, count)); },
+			[&](size_t row) { _add(_numbers[row]); });
+	}
+	else if (column.type() == json_column_type::integer)
+	{
+		const int64_t *_integers = column.integers();
+		int64_t _i = 0;
+		bool _any = false;
+		auto _row = [&](size_t row)
+		{
+			if (!_any || (MIN ? _integers[row] < _i : _integers[row] > _i))
+				_i = _integers[row];
+			_any = true;
+		};
+		for_each_row(column.valid(), selection, column.size(),
+			[&](size_t first, size_t count) { for (size_t i = first; i < first + count; i++) _row(i); },
+			_row);
+		if (_any)
+			_add((double)_i);
+	}
+	else
+		JSON_ASSERT(column.type() == json_column_type::null, "json_column : not a number column");
+
+	if (!_found)
+		return std::nullopt;
+	return _bound;
+}
+
+std::optional<double> json_column::min(const json_bitmap *selection) const
+{
+	return bound<true>(*this, selection);
+}
+
+std::optional<double> json_column::max(const json_bitmap *selection) const
+{
+	return bound<false>(*this, selection);
+}
+
+void json_column::filter(json_compare op, double value, json_bitmap& selection) const
+{
+	if (m_type == json_column_type::number)
+	{
+		dispatch(op, [&]<json_compare OP>()
+		{
+			narrow(m_valid, selection, [&](size_t first, size_t count) { return match_numbers<OP>(m_numbers.data() + first, count, value); });
+		});
+	}
+	else if (m_type == json_column_type::integer)
+	{
+		dispatch(op, [&]<json_compare OP>()
+		{
+			narrow(m_valid, selection, [&](size_t first, size_t count)
+			{
+				uint64_t _bits = 0;
+				for (size_t i = 0; i < count; i++)
+					_bits |= (uint64_t)compare<OP>((double)m_integers[first + i], value) << i;
+				return _bits;
+			});
+		});
+	}
+	else
+		narrow(m_valid, selection, [](size_t, size_t) { return (uint64_t)0; });
+}
+
+void json_column::filter(json_compare op, std::string_view value, json_bitmap& selection) const
+{
+	if (m_type != json_column_type::string)
+	{
+		narrow(m_valid, selection, [](size_t, size_t) { return (uint64_t)0; });
+		return;
+	}
+
+	if (op == json_compare::equal || op == json_compare::not_equal)
+	{
+		// a string that is not in the dictionary matches no row
+		size_t _code = 0;
+		while (_code < m_dictionary.size() && m_dictionary[_code] != value)
+			_code++;
+		const uint64_t _flip = op == json_compare::not_equal ? ~(uint64_t)0 : 0;
+		if (_code == m_dictionary.size())
+		{
+			narrow(m_valid, selection, [&](size_t, size_t) { return _flip; });
+			return;
+		}
+		narrow(m_valid, selection, [&](size_t first, size_t count) { return match_code(m_codes.data() + first, count, (uint32_t)_code) ^ _flip; });
+		return;
+	}
+
+	// ordering is decided once per dictionary entry, the rows look it up
+	std::vector<uint8_t> _matches(m_dictionary.size());
+	dispatch(op, [&]<json_compare OP>()
+	{
+		for (size_t i = 0; i < m_dictionary.size(); i++)
+			_matches[i] = compare<OP>(std::string_view(m_dictionary[i]), value);
+	});
+	narrow(m_valid, selection, [&](size_t first, size_t count)
+	{
+		uint64_t _bits = 0;
+		for (size_t i = 0; i < count; i++)
+			_bits |= (uint64_t)_matches[m_codes[first + i]] << i;
+		return _bits;
+	});
+}
+
+void json_column::filter(json_compare op, bool value, json_bitmap& selection) const
+{
+	if (m_type != json_column_type::boolean)
+	{
+		narrow(m_valid, selection, [](size_t, size_t) { return (uint64_t)0; });
+		return;
+	}
+
+	dispatch(op, [&]<json_compare OP>()
+	{
+		narrow(m_valid, selection, [&](size_t first, size_t count)
+		{
+			uint64_t _bits = 0;
+			for (size_t i = 0; i < count; i++)
+				_bits |= (uint64_t)compare<OP>(m_booleans[first + i], (uint8_t)value) << i;
+			return _bits;
+		});
+	});
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_table
+//////////////////////////////////////////////////////////////////////////
+
+// the column of the member, members usually come in the same order in
+// every row so the one at the same position is tried first
+static size_t find_column(const std::vector<json_column>& columns, const std::unordered_map<std::string_view, size_t>& names, std::string_view key, size_t position)
+{
+	if (position < columns.size() && columns[position].name() == key)
+		return position;
+	auto _it = names.find(key);
+	return _it != names.end() ? _it->second : columns.size();
+}
+
+static json_column_type merge_type(json_column_type column, const json_var& var)
+{
+	json_column_type _type;
+	switch (var.type)
+	{
+	case json_type::null:
+		return column;
+	case json_type::number:
+	{
+		// integers past 2^24 are still whole as doubles, the lazy ones are read exactly below
+		const double _n = var.to_double();
+		_type = std::trunc(_n) == _n && std::fabs(_n) < 9.2e18 ? json_column_type::integer : json_column_type::number;
+		break;
+	}
+	case json_type::boolean:	_type = json_column_type::boolean; break;
+	case json_type::string:		_type = json_column_type::string; break;
+	default:					_type = json_column_type::variant; break;
+	}
+
+	if (column == json_column_type::null || column == _type)
+		return _type;
+	if ((column == json_column_type::integer && _type == json_column_type::number) ||
+		(column == json_column_type::number && _type == json_column_type::integer))
+		return json_column_type::number;
+	return json_column_type::variant;
+}
+
+bool json_table::assign(const json_array& arr)
+{
+	clear();
+
+	// first pass, the columns and their types
+	std::unordered_map<std::string_view, size_t> _names;
+	for (size_t r = 0; r < arr.count(); r++)
+	{
+		if (!arr[r].is_object())
+		{
+			clear();
+			return false;
+		}
+		const json_object& _row = arr[r].to_object();
+		for (size_t m = 0; m < _row.count(); m++)
+		{
+			const json_key& _key = _row.get_key(m);
+			size_t _c = find_column(m_columns, _names, _key, m);
+			if (_c == m_columns.size())
+			{
+				m_columns.emplace_back();
+				m_columns.back().m_name.assign(_key.data(), _key.size());
+				_names.emplace(std::string_view(_key.data(), _key.size()), _c);
+			}
+			m_columns[_c].m_type = merge_type(m_columns[_c].m_type, _row[m]);
+		}
+	}
+
+	m_rows = arr.count();
+	for (json_column& _column : m_columns)
+	{
+		_column.m_rows = m_rows;
+		_column.m_valid = json_bitmap(m_rows, false);
+		switch (_column.m_type)
+		{
+		case json_column_type::number:	_column.m_numbers.resize(m_rows); break;
+		case json_column_type::integer:	_column.m_integers.resize(m_rows); break;
+		case json_column_type::boolean:	_column.m_booleans.resize(m_rows); break;
+		case json_column_type::string:	_column.m_codes.resize(m_rows); break;
+		case json_column_type::variant:	_column.m_vars.resize(m_rows); break;
+		default: break;
+		}
+	}
+
+	// second pass, the values. the dictionaries point into the array while it is built
+	std::vector<std::unordered_map<std::string_view, uint32_t>> _codes(m_columns.size());
+	for (size_t r = 0; r < m_rows; r++)
+	{
+		const json_object& _row = arr[r].to_object();
+		for (size_t m = 0; m < _row.count(); m++)
+		{
+			const json_var& _var = _row[m];
+			if (_var.is_null())
+				continue;
+			const size_t _c = find_column(m_columns, _names, _row.get_key(m), m);
+			json_column& _column = m_columns[_c];
+			_column.m_valid.set(r);
+			switch (_column.m_type)
+			{
+			case json_column_type::number:	_column.m_numbers[r] = _var.to_double(); break;
+			case json_column_type::integer:	_column.m_integers[r] = _var.to_integer(); break;
+			case json_column_type::boolean:	_column.m_booleans[r] = _var.to_boolean() ? 1 : 0; break;
+			case json_column_type::string:
+			{
+				const json_string& _str = _var.to_string();
+				auto _it = _codes[_c].try_emplace(std::string_view(_str.get(), _str.size()), (uint32_t)_column.m_dictionary.size());
+				if (_it.second)
+					_column.m_dictionary.emplace_back(_str.get(), _str.size());
+				_column.m_codes[r] = _it.first->second;
+				break;
+			}
+			case json_column_type::variant:	_column.m_vars[r] = _var; break;
+			default: break;
+			}
+		}
+	}
+
+	for (json_column& _column : m_columns)
+		_column.m_nulls = m_rows - _column.m_valid.count();
+	return true;
+}
+
+bool json_table::assign(const json_var& var)
+{
+	if (!var.is_array())
+	{
+		clear();
+		return false;
+	}
+	return assign(var.to_array());
+}
+
+void json_table::clear()
+{
+	m_columns.clear();
+	m_rows = 0;
+}
+
+const json_column* json_table::column(std::string_view name) const
+{
+	for (const json_column& _column : m_columns)
+		if (_column.name() == name)
+			return &_column;
+	return nullptr;
+}
+
+json_var json_table::to_array(const json_bitmap *selection) const
+{
+	json_var _arr = json_array();
+	json_array& _a = _arr.to_array();
+	for (size_t r = 0; r < m_rows; r++)
+	{
+		if (selection != nullptr && !selection->test(r))
+			continue;
+		json_var _row = json_object();
+		json_object& _o = _row.to_object();
+		for (const json_column& _column : m_columns)
+			if (!_column.is_null(r))
+				_o[std::string_view(_column.name())] = _column.get(r);
+		_a.add(_row);
+	}
+	return _arr;
+}
\ No newline at end of file
@@ -0,0 +1,474 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_validate.h>
+
+#if defined(JSON_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(JSON_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////
+
+static inline unsigned first_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward(&i, mask);
+	return (unsigned)i;
+#else
+	return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+static inline bool is_digit(uint8_t c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline bool is_hex(uint8_t c)
+{
+	return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// length of the well formed UTF-8 sequence at p (Unicode table 3-7), 0 if there is none
+static size_t utf8_sequence(const uint8_t *p, const uint8_t *end)
+{
+	uint8_t c = p[0];
+	size_t n;
+	uint8_t lo = 0x80, hi = 0xbf;	// bounds of the second byte
+
+	if (c >= 0xc2 && c <= 0xdf)
+		n = 2;
+	else if (c >= 0xe0 && c <= 0xef)
+	{
+		n = 3;
+		if (c == 0xe0)
+			lo = 0xa0;
+		else if (c == 0xed)
+			hi = 0x9f;
+	}
+	else if (c >= 0xf0 && c <= 0xf4)
+	{
+		n = 4;
+		if (c == 0xf0)
+			lo = 0x90;
+		else if (c == 0xf4)
+			hi = 0x8f;
+	}
+	else
+		return 0;
+
+	if ((size_t)(end - p) < n || p[1] < lo || p[1] > hi)
+		return 0;
+	for (size_t i = 2; i < n; i++)
+		if ((p[i] & 0xc0) != 0x80)
+			return 0;
+	return n;
+}
+
+// skips plain string content: stops on the quote, a backslash, a control
+// character or the first byte of a non ASCII sequence
+static inline const uint8_t* scan_string(const uint8_t *p, const uint8_t *end, uint8_t quote)
+{
+#if defined(JSON_SIMD_SSE2)
+	const __m128i _quote = _mm_set1_epi8((char)quote);
+	const __m128i _backslash = _mm_set1_epi8('\\');
+	const __m128i _space = _mm_set1_epi8(0x20);
+	while (end - p >= 16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)p);
+		// the signed compare catches both the control characters and the bytes >= 0x80
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _quote), _mm_cmpeq_epi8(v, _backslash)), _mm_cmplt_epi8(v, _space));
+		unsigned mask = (unsigned)_mm_movemask_epi8(m);
+		if (mask != 0)
+			return p + first_bit(mask);
+		p += 16;
+	}
+#elif defined(JSON_SIMD_NEON)
+	const uint8x16_t _quote = vdupq_n_u8(quote);
+	const uint8x16_t _backslash = vdupq_n_u8('\\');
+	const uint8x16_t _space = vdupq_n_u8(0x20);
+	const uint8x16_t _high = vdupq_n_u8(0x80);
+	while (end - p >= 16)
+	{
+		uint8x16_t v = vld1q_u8(p);
+		uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, _quote), vceqq_u8(v, _backslash)),
+			vorrq_u8(vcltq_u8(v, _space), vcgeq_u8(v, _high)));
+		if (vmaxvq_u8(m) != 0)
+			break;
+		p += 16;
+	}
+#endif
+	while (p < end && *p != quote && *p != '\\' && *p >= 0x20 && *p < 0x80)
+		p++;
+	return p;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_validator
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	class json_validator
+	{
+	private:
+		const uint8_t *m_begin;
+		const uint8_t *m_end;
+		const uint8_t *p;
+		bool m_permissive;
+		bool m_utf8;	// checked unless the validator skips a value for the parser
+		size_t m_depth;
+		size_t m_max_depth;
+		uint64_t m_objects[(JSON_VALIDATE_INLINE_DEPTH + 63) / 64];	// 1 for an object, 0 for an array
+		std::vector<uint64_t> m_deeper;	// the bits past JSON_VALIDATE_INLINE_DEPTH
+
+		// the end of the input reads as a '\0', which is never valid where a token is expected
+		inline uint8_t peek() const { return p < m_end ? *p : 0; }
+
+		bool skip_whitespace();
+		bool hex4(uint32_t& cp);
+		bool string();
+		bool number();
+		bool literal(const char *word, size_t length);
+
+		inline uint64_t& word(size_t depth)
+		{
+			if (depth < JSON_VALIDATE_INLINE_DEPTH)
+				return m_objects[depth / 64];
+			size_t _index = (depth - JSON_VALIDATE_INLINE_DEPTH) / 64;
+			if (_index >= m_deeper.size())
+				m_deeper.resize(_index + 1);
+			return m_deeper[_index];
+		}
+
+		inline bool push(bool object)
+		{
+			if (m_depth >= m_max_depth)
+				return false;
+			uint64_t _bit = (uint64_t)1 << (m_depth % 64);
+			if (object)
+				word(m_depth) |= _bit;
+			else
+				word(m_depth) &= ~_bit;
+			m_depth++;
+			return true;
+		}
+
+		inline bool in_object()
+		{
+			return (word(m_depth - 1) >> ((m_depth - 1) % 64)) & 1;
+		}
+
+	public:
+		json_validator(const char *buf, size_t length, parse_mode mode, size_t max_depth, bool utf8 = true)
+			: m_begin((const uint8_t*)buf), m_end((const uint8_t*)buf + length), p(m_begin),
+			m_permissive(mode == parse_mode::permissive), m_utf8(utf8), m_depth(0), m_max_depth(max_depth)
+		{
+		}
+
+		inline const char* position() const { return (const char*)p; }
+
+		bool value();
+		json_validate_result run();
+	};
+}
+
+bool json_validator::skip_whitespace()
+{
+	while (p < m_end)
+	{
+		uint8_t c = *p;
+		if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+			p++;
+		else if (m_permissive && c == '/')
+		{
+			if (p + 1 < m_end && p[1] == '/')
+			{
+				p += 2;
+				while (p < m_end && *p != '\n' && *p != '\r')
+				{
+					if (*p < 0x80)
+						p++;
+					else if (size_t n = m_utf8 ? utf8_sequence(p, m_end) : 1)
+						p += n;
+					else
+						return false;
+				}
+			}
+			else if (p + 1 < m_end && p[1] == '*')
+			{
+				const uint8_t *_start = p;
+				p += 2;
+				while (p + 1 < m_end && !(p[0] == '*' && p[1] == '/'))
+				{
+					if (*p < 0x80)
+						p++;
+					else if (size_t n = m_utf8 ? utf8_sequence(p, m_end) : 1)
+						p += n;
+					else
+						return false;
+				}
+				if (p + 1 >= m_end)
+				{
+					p = _start;
+					return false;
+				}
+				p += 2;
+			}
+			else
+				return false;
+		}
+		else
+			break;
+	}
+	return true;
+}
+
+// the four hex digits of a \u escape, p is left on the first that is not one
+bool json_validator::hex4(uint32_t& cp)
+{
+	cp = 0;
+	for (int i = 0; i < 4; i++, p++)
+	{
+		uint8_t c = peek();
+		if (!is_hex(c))
+			return false;
+		cp = (cp << 4) | (uint32_t)(is_digit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+	}
+	return true;
+}
+
+bool json_validator::string()
+{
+	uint8_t _quote = *p++;
+	for (;;)
+	{
+		p = scan_string(p, m_end, _quote);
+		if (p == m_end)
+			return false;
+
+		uint8_t c = *p;
+		if (c == _quote)
+		{
+			p++;
+			return true;
+		}
+		else if (c == '\\')
+		{
+			p++;
+			c = peek();
+			if (c == '\"' || c == '\\' || c == '/' || c == 'b' || c == 'f' || c == 'n' || c == 'r' || c == 't')
+				p++;
+			else if (c == 'u')
+			{
+				p++;
+				uint32_t _cp;
+				if (!hex4(_cp))
+					return false;
+				// a surrogate has to be the high half of a pair, as for the parser
+				if (_cp >= 0xdc00 && _cp <= 0xdfff)
+					return false;
+				if (_cp >= 0xd800 && _cp <= 0xdbff)
+				{
+					if (peek() != '\\' || p + 1 >= m_end || p[1] != 'u')
+						return false;
+					p += 2;
+					if (!hex4(_cp) || _cp < 0xdc00 || _cp > 0xdfff)
+						return false;
+				}
+			}
+			else
+				return false;
+		}
+		else if (c >= 0x80)
+		{
+			size_t n = m_utf8 ? utf8_sequence(p, m_end) : 1;
+			if (n == 0)
+				return false;
+			p += n;
+		}
+		else
+			return false;	// control character
+	}
+}
+
+bool json_validator::number()
+{
+	if (peek() == '-')
+		p++;
+
+	if (peek() == '0')
+		p++;
+	else if (is_digit(peek()))
+		while (is_digit(peek()))
+			p++;
+	else
+		return false;
+
+	if (peek() == '.')
+	{
+		p++;
+		if (!is_digit(peek()))
+			return false;
+		while (is_digit(peek()))
+			p++;
+	}
+
+	if (peek() == 'e' || peek() == 'E')
+	{
+		p++;
+		if (peek() == '+' || peek() == '-')
+			p++;
+		if (!is_digit(peek()))
+			return false;
+		while (is_digit(peek()))
+			p++;
+	}
+	return true;
+}
+
+bool json_validator::literal(const char *word, size_t length)
+{
+	if ((size_t)(m_end - p) < length || memcmp(p, word, length) != 0)
+		return false;
+	p += length;
+	return true;
+}
+
+// one value at p, p is left after it, or on the first offending byte
+bool json_validator::value()
+{
+	enum { expect_value, expect_key, after_value } _state = expect_value;
+
+	for (;;)
+	{
+		bool _ok = true;
+		if (_state == expect_value)
+		{
+			uint8_t c = peek();
+			if (c == '{' || c == '[')
+			{
+				if (!push(c == '{'))
+					break;
+				p++;
+				if (!skip_whitespace())
+					break;
+				if (peek() == (c == '{' ? '}' : ']'))
+				{
+					p++;
+					m_depth--;
+					_state = after_value;
+				}
+				else
+					_state = c == '{' ? expect_key : expect_value;
+				continue;
+			}
+			else if (c == '\"' || (m_permissive && c == '\''))
+				_ok = string();
+			else if (c == '-' || is_digit(c))
+				_ok = number();
+			else if (c == 't')
+				_ok = literal("true", 4);
+			else if (c == 'f')
+				_ok = literal("false", 5);
+			else if (c == 'n')
+				_ok = literal("null", 4);
+			else
+				_ok = false;
+			_state = after_value;
+		}
+		else if (_state == expect_key)
+		{
+			uint8_t c = peek();
+			_ok = (c == '\"' || (m_permissive && c == '\'')) && string() && skip_whitespace() && peek() == ':';
+			if (_ok)
+			{
+				p++;
+				_ok = skip_whitespace();
+			}
+			_state = expect_value;
+		}
+		else
+		{
+			if (m_depth == 0)
+				return true;
+			if (!skip_whitespace())
+				break;
+
+			uint8_t c = peek();
+			if (c == ',')
+			{
+				p++;
+				_ok = skip_whitespace();
+				_state = in_object() ? expect_key : expect_value;
+			}
+			else if (c == (in_object() ? '}' : ']'))
+			{
+				p++;
+				m_depth--;
+			}
+			else
+				_ok = false;
+		}
+
+		if (!_ok)
+			break;
+	}
+	return false;
+}
+
+json_validate_result json_validator::run()
+{
+	if (skip_whitespace() && peek() == '{' && value() && skip_whitespace() && p == m_end)
+		return { true, (size_t)(m_end - m_begin) };
+	return { false, (size_t)(p - m_begin) };
+}
+
+//////////////////////////////////////////////////////////////////////////
+// json_validate
+//////////////////////////////////////////////////////////////////////////
+
+json_validate_result json_validate(const char *buf, size_t length, parse_mode mode, size_t max_depth)
+{
+	json_validator _validator(buf, length, mode, max_depth);
+	return _validator.run();
+}
+
+// used by the projections of json_parser to skip what they leave out, so a
+// projected load accepts the documents a full load does. depth containers
+// are open around the value, and the bytes are not checked as UTF-8 since
+// the parser copies them as they are.
+bool json_validate_skip(const char *&p, const char *end, parse_mode mode, size_t depth, size_t max_depth)
+{
+	json_validator _validator(p, (size_t)(end - p), mode, max_depth > depth ? max_depth - depth : 0, false);
+	bool _ok = _validator.value();
+	p = _validator.position();
+	return _ok;
+}
\ No newline at end of file
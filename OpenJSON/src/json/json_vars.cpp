@@ -1,552 +1,1933 @@
-/*
-
-Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
-
-This file is part of OpenJSON.
-
-OpenJSON is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or
-(at your option) any later version.
-
-OpenJSON is distributed in the hope that it will be useful,
-but WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-GNU General Public License for more details.
-
-You should have received a copy of the GNU General Public License
-along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
-
-*/
-
-#include <json/json_vars.h>
-
-//////////////////////////////////////////////////////////////////////////
-//	json_string
-//////////////////////////////////////////////////////////////////////////
-
-json_string::json_string()
-{
-	m_string = nullptr;
-	m_length = 0;
-}
-
-json_string::json_string(const char *str)
-{
-	m_length = strlen(str);
-	m_string = new char[m_length + 1];
-	std::strcpy(m_string, str);
-}
-
-json_string::json_string(const std::string& str)
-{
-	m_length = str.size();
-	m_string = new char[m_length + 1];
-	std::strcpy(m_string, str.c_str());
-}
-
-json_string::json_string(const json_string& str)
-{
-	m_length = str.m_length;
-	m_string = new char[m_length + 1];
-	std::strcpy(m_string, str.m_string);
-}
-
-json_string::~json_string()
-{
-	if (m_string != nullptr)
-		delete[] m_string;
-}
-
-void json_string::operator=(const char *str)
-{
-	m_length = strlen(str);
-	m_string = new char[m_length + 1];
-	std::strcpy(m_string, str);
-}
-
-void json_string::operator=(const std::string& str)
-{
-	m_length = str.size();
-	m_string = new char[m_length + 1];
-	std::strcpy(m_string, str.c_str());
-}
-
-void json_string::operator=(const json_string& str)
-{
-	m_length = str.m_length;
-	m_string = new char[m_length + 1];
-	std::strcpy(m_string, str.m_string);
-}
-
-bool json_string::operator==(const char *str)
-{
-	return std::strcmp(m_string, str) == 0;
-}
-
-bool json_string::operator==(const std::string& str)
-{
-	return operator==(str.c_str());
-}
-
-bool json_string::operator==(const json_string& str)
-{
-	return operator==(str.m_string);
-}
-
-bool json_string::operator!=(const char *str)
-{
-	return !operator==(str);
-}
-
-bool json_string::operator!=(const std::string& str)
-{
-	return !operator==(str);
-}
-
-bool json_string::operator!=(const json_string& str)
-{
-	return !operator==(str);
-}
-
-//////////////////////////////////////////////////////////////////////////
-//	json_array
-//////////////////////////////////////////////////////////////////////////
-
-json_array::json_array(const std::initializer_list<json_var>& list)
-	: m_data(list)
-{
-}
-
-void json_array::add(const json_var& var)
-{
-	m_data.emplace_back(var);
-}
-
-void json_array::remove(size_t index)
-{
-	JSON_ASSERT(index >= 0 && index < count(), "json_array : index out of range");
-	m_data.erase(m_data.begin() + index);
-}
-
-json_var& json_array::get(size_t index)
-{
-	JSON_ASSERT(index >= 0 && index < count(), "json_array : index out of range");
-	return m_data[index];
-}
-
-json_var& json_array::operator[](size_t index)
-{
-	JSON_ASSERT(index >= 0 && index < count(), "json_array : index out of range");
-	return m_data[index];
-}
-
-//////////////////////////////////////////////////////////////////////////
-//	json_object
-//////////////////////////////////////////////////////////////////////////
-
-json_object::json_object()
-{
-}
-
-json_var& json_object::get(const std::string& key)
-{
-	size_t i;
-	for (i = 0; i < m_keys.size(); i++)
-		if (m_keys[i] == key)
-			break;
-	if (i == m_keys.size())
-	{
-		m_keys.emplace_back(key);
-		m_vars.emplace_back();
-	}
-	return m_vars[i];
-}
-
-const std::string& json_object::get_key(size_t index)
-{
-	JSON_ASSERT(index >= 0 && index < count(), "json_object : index out of range");
-	return m_keys[index];
-}
-
-json_var& json_object::operator[](size_t index)
-{
-	JSON_ASSERT(index >= 0 && index < count(), "json_object : index out of range");
-	return m_vars[index];
-}
-
-json_var& json_object::operator[](const std::string& key)
-{
-	return get(key);
-}
-
-//////////////////////////////////////////////////////////////////////////
-//	helper functions
-//////////////////////////////////////////////////////////////////////////
-
-void clean(json_var& var)
-{
-	if (var.type == json_type::object && var.value.object != nullptr)
-		delete var.value.object;
-	else if (var.type == json_type::array && var.value.array != nullptr)
-		delete var.value.array;
-	else if (var.type == json_type::string && var.value.string != nullptr)
-		delete var.value.string;
-}
-
-json_object* create_object(const json_object& obj)
-{
-	return new json_object(obj);
-}
-
-json_array* create_array(const std::initializer_list<json_var>& list)
-{
-	return new json_array(list);
-}
-
-json_array* create_array(const json_array& arr)
-{
-	return new json_array(arr);
-}
-
-json_string* create_string(const char* str)
-{
-	return new json_string(str);
-}
-
-json_string* create_string(const std::string& str)
-{
-	return new json_string(str);
-}
-
-json_string* create_string(const json_string& str)
-{
-	return new json_string(str);
-}
-
-//////////////////////////////////////////////////////////////////////////
-//	json_var
-//////////////////////////////////////////////////////////////////////////
-
-json_var::json_var()
-{
-	type = json_type::null;
-}
-
-json_var::json_var(const std::nullptr_t& t)
-{
-	type = json_type::null;
-}
-
-json_var::json_var(const json_var& var)
-{
-	clean(*this);
-	type = var.type;
-	if (type == json_type::object)
-		value.object = create_object(*var.value.object);
-	else if (type == json_type::array)
-		value.array = create_array(*var.value.array);
-	else if (type == json_type::string)
-		value.string = create_string(*var.value.string);
-	else if (type == json_type::boolean)
-		value.boolean = var.value.boolean;
-	else if (type == json_type::number)
-		value.number = var.value.number;
-}
-
-json_var::json_var(const json_object& obj)
-{
-	type = json_type::object;
-	value.object = create_object(obj);
-}
-
-json_var::json_var(const std::initializer_list<json_var>& list)
-{
-	type = json_type::array;
-	value.array = create_array(list);
-}
-
-json_var::json_var(const json_array& arr)
-{
-	type = json_type::array;
-	value.array = create_array(arr);
-}
-
-json_var::json_var(const char *str)
-{
-	type = json_type::string;
-	value.string = create_string(str);
-}
-
-json_var::json_var(const std::string& str)
-{
-	type = json_type::string;
-	value.string = create_string(str);
-}
-
-json_var::json_var(const json_string& str)
-{
-	type = json_type::string;
-	value.string = create_string(str);
-}
-
-json_var::json_var(const json_boolean boolean)
-{
-	type = json_type::boolean;
-	value.boolean = boolean;
-}
-
-json_var::json_var(const json_number number)
-{
-	type = json_type::number;
-	value.number = number;
-}
-
-json_var& json_var::get(size_t index)
-{
-	JSON_ASSERT(is_array(), "json_var : not an array");
-	return (*value.array)[index];
-}
-
-json_var& json_var::get(const std::string& key)
-{
-	JSON_ASSERT(is_object(), "json_var : not an object");
-	return (*value.object).get(key);
-}
-
-const std::string& json_var::get_key(size_t index)
-{
-	JSON_ASSERT(is_object(), "json_var : not an object");
-	return (*value.object).get_key(index);
-}
-
-void json_var::operator=(const std::nullptr_t & t)
-{
-	clean(*this);
-	type = json_type::null;
-}
-
-void json_var::operator=(const json_var& var)
-{
-	clean(*this);
-	type = var.type;
-	if (type == json_type::object)
-		value.object = create_object(*var.value.object);
-	else if (type == json_type::array)
-		value.array = create_array(*var.value.array);
-	else if (type == json_type::string)
-		value.string = create_string(*var.value.string);
-	else if (type == json_type::boolean)
-		value.boolean = var.value.boolean;
-	else if (type == json_type::number)
-		value.number = var.value.number;
-}
-
-void json_var::operator=(const json_object& obj)
-{
-	clean(*this);
-	type = json_type::object;
-	value.object = create_object(obj);
-}
-
-void json_var::operator=(const std::initializer_list<json_var>& list)
-{
-	clean(*this);
-	type = json_type::array;
-	value.array = create_array(list);
-}
-
-void json_var::operator=(const json_array& arr)
-{
-	clean(*this);
-	type = json_type::array;
-	value.array = create_array(arr);
-}
-
-void json_var::operator=(const char *str)
-{
-	clean(*this);
-	type = json_type::string;
-	value.string = create_string(str);
-}
-
-void json_var::operator=(const std::string& str)
-{
-	clean(*this);
-	type = json_type::string;
-	value.string = create_string(str);
-}
-
-void json_var::operator=(const json_string& str)
-{
-	clean(*this);
-	type = json_type::string;
-	value.string = create_string(str);
-}
-
-void json_var::operator=(json_boolean boolean)
-{
-	type = json_type::boolean;
-	value.boolean = boolean;
-}
-
-void json_var::operator=(json_number number)
-{
-	type = json_type::number;
-	value.number = number;
-}
-
-json_var::operator json_object&()
-{
-	return to_object();
-}
-
-json_var::operator json_array&()
-{
-	return to_array();
-}
-
-json_var::operator json_string&()
-{
-	return to_string();
-}
-
-json_var::operator json_boolean()
-{
-	return to_boolean();
-}
-
-json_var::operator json_number()
-{
-	return to_number();
-}
-
-json_var& json_var::operator[](size_t index)
-{
-	JSON_ASSERT(is_array() || is_object(), "json_var : not an array nor an object");
-	if (is_array())
-		return (*value.array)[index];
-	else
-		return (*value.object)[index];
-}
-
-json_var& json_var::operator[](const std::string& key)
-{
-	if (is_null())
-		*this = json_object();
-	JSON_ASSERT(is_object(), "json_var : not an object");
-	return (*value.object)[key];
-}
-
-//////////////////////////////////////////////////////////////////////////
-// helper functions
-//////////////////////////////////////////////////////////////////////////
-
-void write_object(std::ostream& stream, json_object& obj, int indent = 1)
-{
-	if (obj.count() <= 0)
-	{
-		//stream << "{}";
-		return;
-	}
-	size_t i;
-	for (i = 0; i < obj.count() - 1; i++)
-	{
-		for (int j = 0; j < indent; j++)
-			stream << "\t";
-		if (obj[i].is_string())
-			stream << "\"" << obj.get_key(i) << "\" : \"" << obj[i] << "\",\n";
-		else if (!obj[i].is_object())
-			stream << "\"" << obj.get_key(i) << "\" : " << obj[i] << ",\n";
-		else
-		{
-			stream << "\"" << obj.get_key(i) << "\" : \n";
-			for (int j = 0; j < indent; j++)
-				stream << "\t";
-			stream << "{\n";
-			write_object(stream, obj[i], indent + 1);
-			stream << "\n";
-			for (int j = 0; j < indent; j++)
-				stream << "\t";
-			stream << "},\n";
-		}
-	}
-
-	for (int j = 0; j < indent; j++)
-		stream << "\t";
-
-	if (obj[i].is_string())
-		stream << "\"" << obj.get_key(i) << "\" : \"" << obj[i] << "\"\n";
-	else if (!obj[i].is_object())
-		stream << "\"" << obj.get_key(i) << "\" : " << obj[i];
-	else
-	{
-		stream << "\"" << obj.get_key(i) << "\" : \n";
-		for (int j = 0; j < indent; j++)
-			stream << "\t";
-		stream << "{\n";
-		write_object(stream, obj[i], indent + 1);
-		stream << "\n";
-		for (int j = 0; j < indent; j++)
-			stream << "\t";
-		stream << "}";
-	}
-}
-
-//////////////////////////////////////////////////////////////////////////
-//	operators
-//////////////////////////////////////////////////////////////////////////
-
-std::ostream& operator<<(std::ostream& stream, json_string& str)
-{
-	stream << str.get();
-	return stream;
-}
-
-std::ostream& operator<<(std::ostream& stream, json_array& arr)
-{
-	if (arr.count() == 0)
-	{
-		stream << "[]";
-		return stream;
-	}
-
-	stream << "[ ";
-	for (size_t i = 0; i < arr.count() - 1; i++)
-	{
-		if (arr[i].is_string())
-			stream << "\"" << arr[i] << "\", ";
-		else
-			stream << arr[i] << ", ";
-	}
-	if (arr[arr.count() - 1].is_string())
-		stream << "\"" << arr[arr.count() - 1] << "\" ]";
-	else
-		stream << arr[arr.count() - 1] << " ]";
-	return stream;
-}
-
-std::ostream& operator<<(std::ostream& stream, json_object& obj)
-{
-	stream << "{\n";
-	write_object(stream, obj);
-	stream << "\n}";
-	return stream;
-}
-
-std::ostream& operator<<(std::ostream& stream, json_var& var)
-{
-	if (var.type == json_type::array)
-		stream << *var.value.array;
-	else if (var.type == json_type::string)
-		stream << *var.value.string;
-	else if (var.type == json_type::number)
-		stream << var.value.number;
-	else if (var.type == json_type::boolean)
-		stream << (var.value.boolean ? "true" : "false");
-	else if (var.type == json_type::null)
-		stream << "null";
-	else if (var.type == json_type::object)
-		stream << *var.value.object;
-	return stream;
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_vars.h>
+#include <json/json_escape.h>
+#include <json/json_stats.h>
+
+#include <charconv>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+
+// smallest serialized container whose bytes are kept (JSON_ENABLE_WRITE_CACHE)
+#ifndef JSON_WRITE_CACHE_MIN
+	#define JSON_WRITE_CACHE_MIN 256
+#endif
+
+// containers nested deeper are written without their cache, every cached
+// level holds a copy of the levels below it
+#ifndef JSON_WRITE_CACHE_DEPTH
+	#define JSON_WRITE_CACHE_DEPTH 64
+#endif
+
+// kernels of the packed arrays, in json_table.cpp, the bounds need n > 0
+double json_sum_run(const float *p, size_t n);
+double json_sum_run(const double *p, size_t n);
+double json_sum_run(const int64_t *p, size_t n);
+double json_min_run(const float *p, size_t n);
+double json_min_run(const double *p, size_t n);
+double json_min_run(const int64_t *p, size_t n);
+double json_max_run(const float *p, size_t n);
+double json_max_run(const double *p, size_t n);
+double json_max_run(const int64_t *p, size_t n);
+
+//////////////////////////////////////////////////////////////////////////
+//	json_node
+//////////////////////////////////////////////////////////////////////////
+
+std::atomic<uint64_t> g_json_epoch(1);
+std::atomic<bool> g_json_epoch_taken(false);
+
+// serialized bytes of a node, allocated in one block from the node's resource
+struct json_write_cache
+{
+	uint64_t key;
+	uint64_t epoch;		// 0 when the bytes hold for good
+	size_t size;
+
+	inline char* bytes() { return reinterpret_cast<char*>(this + 1); }
+	inline const char* bytes() const { return reinterpret_cast<const char*>(this + 1); }
+	inline static size_t block(size_t size) { return sizeof(json_write_cache) + size; }
+};
+
+void json_node::drop_write_cache()
+{
+	json_write_cache *_c = m_write_cache.exchange(nullptr, std::memory_order_acq_rel);
+	if (_c != nullptr)
+		m_resource->deallocate(_c, json_write_cache::block(_c->size), alignof(json_write_cache));
+}
+
+// bytes that are out of date are replaced by the next writer while others
+// may still be checking them, they copy under the shared lock and the old
+// bytes are freed under the exclusive one
+static std::shared_mutex g_write_cache_lock;
+
+static inline bool write_cache_valid(const json_write_cache *c)
+{
+	return c->epoch == 0 || c->epoch == g_json_epoch.load(std::memory_order_relaxed);
+}
+
+bool json_node::write_cached(uint64_t key, std::ostream& out, json_lent& lent) const
+{
+	if (m_write_cache.load(std::memory_order_relaxed) == nullptr)
+		return false;
+	std::shared_lock _lock(g_write_cache_lock);
+	const json_write_cache *_c = m_write_cache.load(std::memory_order_acquire);
+	if (_c == nullptr || _c->key != key || !write_cache_valid(_c))
+		return false;
+	lent = _c->epoch != 0 ? json_lent_refs : json_lent_none;
+	out.write(_c->bytes(), (std::streamsize)_c->size);
+	return true;
+}
+
+// writers only share a node through const references, so valid bytes are
+// never dropped under them. two of them may fill it at once, the first
+// one wins and keeps the other from freeing bytes that are being read.
+void json_node::cache_write(uint64_t key, const std::string& bytes, json_lent lent, uint64_t epoch) const
+{
+	if (lent == json_lent_memory)
+		return;
+	void *_p = m_resource->allocate(json_write_cache::block(bytes.size()), alignof(json_write_cache));
+	json_write_cache *_c = new (_p) json_write_cache{ key, lent == json_lent_refs ? epoch : 0, bytes.size() };
+	memcpy(_c->bytes(), bytes.data(), bytes.size());
+
+	json_write_cache *_expected = nullptr;
+	if (m_write_cache.compare_exchange_strong(_expected, _c, std::memory_order_acq_rel))
+		return;
+	std::unique_lock _lock(g_write_cache_lock);
+	_expected = m_write_cache.load(std::memory_order_acquire);
+	if (_expected != nullptr && !write_cache_valid(_expected))
+	{
+		m_write_cache.store(_c, std::memory_order_release);
+		_c = _expected;
+	}
+	m_resource->deallocate(_c, json_write_cache::block(_c->size), alignof(json_write_cache));
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_string
+//////////////////////////////////////////////////////////////////////////
+
+static char g_empty_string[1] = { '\0' };
+
+json_string::json_string()
+{
+	m_string = g_empty_string;
+	m_length = 0;
+	m_capacity = 0;
+}
+
+json_string::json_string(const char *str)
+	: json_string()
+{
+	assign(str, strlen(str));
+}
+
+json_string::json_string(const char *str, size_t length)
+	: json_string()
+{
+	assign(str, length);
+}
+
+json_string::json_string(const std::string& str)
+	: json_string()
+{
+	assign(str.c_str(), str.size());
+}
+
+json_string::json_string(const json_string& str)
+	: json_node(str)
+{
+	m_string = g_empty_string;
+	m_length = 0;
+	m_capacity = 0;
+	assign(str.m_string, str.m_length);
+}
+
+json_string::~json_string()
+{
+	if (m_capacity > 0)
+		resource()->deallocate(m_string, m_capacity + 1, 1);
+}
+
+void json_string::assign(const char *str, size_t length)
+{
+	invalidate();
+	if (length > m_capacity)
+	{
+		char *_buffer = (char*)resource()->allocate(length + 1, 1);
+		if (m_capacity > 0)
+			resource()->deallocate(m_string, m_capacity + 1, 1);
+		m_string = _buffer;
+		m_capacity = length;
+	}
+	if (length > 0)
+		std::memmove(m_string, str, length);
+	m_length = length;
+	if (m_capacity > 0)
+		m_string[m_length] = '\0';
+}
+
+void json_string::operator=(const char *str)
+{
+	assign(str, strlen(str));
+}
+
+void json_string::operator=(const std::string& str)
+{
+	assign(str.c_str(), str.size());
+}
+
+void json_string::operator=(const json_string& str)
+{
+	assign(str.m_string, str.m_length);
+}
+
+bool json_string::operator==(const char *str) const
+{
+	return m_length == strlen(str) && std::memcmp(m_string, str, m_length) == 0;
+}
+
+bool json_string::operator==(const std::string& str) const
+{
+	return m_length == str.size() && std::memcmp(m_string, str.c_str(), m_length) == 0;
+}
+
+bool json_string::operator==(const json_string& str) const
+{
+	return m_length == str.m_length && std::memcmp(m_string, str.m_string, m_length) == 0;
+}
+
+bool json_string::operator!=(const char *str) const
+{
+	return !operator==(str);
+}
+
+bool json_string::operator!=(const std::string& str) const
+{
+	return !operator==(str);
+}
+
+bool json_string::operator!=(const json_string& str) const
+{
+	return !operator==(str);
+}
+//////////////////////////////////////////////////////////////////////////
+//	json_number_text
+//////////////////////////////////////////////////////////////////////////
+
+// bits of m_converted
+enum : uint8_t
+{
+	JSON_CONVERTED_NUMBER = 1,
+	JSON_CONVERTED_DOUBLE = 2
+};
+
+json_number_text::json_number_text(const char *text, size_t length)
+	: m_refs(1), m_length(0), m_resource(json_get_resource()), m_double(0), m_number(0), m_converted(0), m_large(false)
+{
+	assign(text, length);
+}
+
+json_number_text::json_number_text(const json_number_text& number)
+	: json_number_text(number.data(), number.m_length)
+{
+}
+
+json_number_text::~json_number_text()
+{
+	if (m_large)
+		m_resource->deallocate(m_heap.text, m_heap.capacity + 1, 1);
+}
+
+void json_number_text::assign(const char *text, size_t length)
+{
+	json_epoch_advance();
+	if (length > small_size && (!m_large || length > m_heap.capacity))
+	{
+		char *_buffer = (char*)m_resource->allocate(length + 1, 1);
+		if (m_large)
+			m_resource->deallocate(m_heap.text, m_heap.capacity + 1, 1);
+		m_heap.text = _buffer;
+		m_heap.capacity = length;
+		m_large = true;
+	}
+	char *_text = data();
+	memcpy(_text, text, length);
+	_text[length] = '\0';
+	m_length = (uint32_t)length;
+	m_converted.store(0, std::memory_order_relaxed);
+}
+
+// out of range values saturate
+static inline int64_t to_int64(double n)
+{
+	if (!(n == n))
+		return 0;
+	if (n >= 9223372036854775807.0)
+		return INT64_MAX;
+	if (n <= -9223372036854775808.0)
+		return INT64_MIN;
+	return (int64_t)n;
+}
+
+// threads converting at once store the same value, the bit is set after it
+json_number json_number_text::to_number() const
+{
+	if (m_converted.load(std::memory_order_acquire) & JSON_CONVERTED_NUMBER)
+		return m_number.load(std::memory_order_relaxed);
+	const json_number _n = std::strtof(data(), nullptr);
+	m_number.store(_n, std::memory_order_relaxed);
+	m_converted.fetch_or(JSON_CONVERTED_NUMBER, std::memory_order_release);
+	return _n;
+}
+
+double json_number_text::to_double() const
+{
+	if (m_converted.load(std::memory_order_acquire) & JSON_CONVERTED_DOUBLE)
+		return m_double.load(std::memory_order_relaxed);
+	const double _n = std::strtod(data(), nullptr);
+	m_double.store(_n, std::memory_order_relaxed);
+	m_converted.fetch_or(JSON_CONVERTED_DOUBLE, std::memory_order_release);
+	return _n;
+}
+
+// not kept, reading an integer costs about as much as checking a cache
+int64_t json_number_text::to_integer() const
+{
+	const char *_text = data();
+	int64_t _n;
+	const std::from_chars_result _r = std::from_chars(_text, _text + m_length, _n);
+	if (_r.ec != std::errc() || _r.ptr != _text + m_length)
+		_n = to_int64(to_double());
+	return _n;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_array
+//////////////////////////////////////////////////////////////////////////
+
+static inline size_t packed_bytes(json_packed_type type, size_t count)
+{
+	return (type == json_packed_type::float32 ? sizeof(float) : sizeof(double)) * count;
+}
+
+json_array::json_array()
+	: m_data(resource()), m_packed(nullptr)
+{
+}
+
+json_array::json_array(const std::initializer_list<json_var>& list)
+	: m_data(list, resource()), m_packed(nullptr)
+{
+}
+
+json_array::json_array(std::span<const float> numbers)
+	: m_data(resource()), m_packed(nullptr)
+{
+	if (!numbers.empty())
+		memcpy(allocate_packed(json_packed_type::float32, numbers.size())->data(), numbers.data(), numbers.size_bytes());
+}
+
+json_array::json_array(std::span<const double> numbers)
+	: m_data(resource()), m_packed(nullptr)
+{
+	if (!numbers.empty())
+		memcpy(allocate_packed(json_packed_type::float64, numbers.size())->data(), numbers.data(), numbers.size_bytes());
+}
+
+json_array::json_array(std::span<const int64_t> numbers)
+	: m_data(resource()), m_packed(nullptr)
+{
+	if (!numbers.empty())
+		memcpy(allocate_packed(json_packed_type::int64, numbers.size())->data(), numbers.data(), numbers.size_bytes());
+}
+
+// the elements a const access made are not copied, the copy makes its own
+json_array::json_array(const json_array& arr)
+	: json_node(arr), m_data(resource()), m_packed(nullptr)
+{
+	if (arr.m_packed == nullptr)
+		m_data = arr.m_data;
+	else
+		memcpy(allocate_packed(arr.m_packed->type, arr.m_packed->count)->data(), arr.m_packed->data(), packed_bytes(arr.m_packed->type, arr.m_packed->count));
+}
+
+json_array::~json_array()
+{
+	free_packed();
+}
+
+json_array& json_array::operator=(const json_array& arr)
+{
+	if (this == &arr)
+		return *this;
+	invalidate();
+	free_packed();
+	if (arr.m_packed == nullptr)
+		m_data = arr.m_data;
+	else
+	{
+		m_data.clear();
+		memcpy(allocate_packed(arr.m_packed->type, arr.m_packed->count)->data(), arr.m_packed->data(), packed_bytes(arr.m_packed->type, arr.m_packed->count));
+	}
+	return *this;
+}
+
+void json_array::add(const json_var& var)
+{
+	invalidate();
+	if (m_packed != nullptr)
+		unpack();
+	m_data.emplace_back(var);
+}
+
+void json_array::insert(size_t index, const json_var& var)
+{
+	invalidate();
+	if (m_packed != nullptr)
+		unpack();
+	JSON_ASSERT(index >= 0 && index <= count(), "json_array : index out of range");
+	m_data.emplace(m_data.begin() + index, var);
+}
+
+void json_array::remove(size_t index)
+{
+	invalidate();
+	if (m_packed != nullptr)
+		unpack();
+	JSON_ASSERT(index >= 0 && index < count(), "json_array : index out of range");
+	m_data.erase(m_data.begin() + index);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_array packed numbers
+//////////////////////////////////////////////////////////////////////////
+
+// a block that is large enough and of the right type is kept, its elements
+// made by a const access are not
+json_packed* json_array::allocate_packed(json_packed_type type, size_t count)
+{
+	if (m_packed != nullptr && m_packed->type == type && m_packed->capacity >= count)
+	{
+		drop_view();
+		m_packed->count = count;
+		return m_packed;
+	}
+	free_packed();
+	const size_t _size = sizeof(json_packed) + packed_bytes(type, count);
+	void *_p = resource()->allocate(_size, alignof(json_packed));
+	m_packed = new (_p) json_packed;
+	m_packed->type = type;
+	m_packed->viewed.store(false, std::memory_order_relaxed);
+	m_packed->count = count;
+	m_packed->capacity = count;
+	return m_packed;
+}
+
+// m_data is left as it is
+void json_array::free_packed()
+{
+	if (m_packed == nullptr)
+		return;
+	const size_t _size = sizeof(json_packed) + packed_bytes(m_packed->type, m_packed->capacity);
+	m_packed->~json_packed();
+	resource()->deallocate(m_packed, _size, alignof(json_packed));
+	m_packed = nullptr;
+}
+
+void json_array::drop_view()
+{
+	if (m_packed->viewed.load(std::memory_order_relaxed))
+	{
+		m_data.clear();
+		m_packed->viewed.store(false, std::memory_order_relaxed);
+	}
+}
+
+// arrays read from several threads at once make their elements under a
+// lock, one of a few picked by the address of the array
+static std::mutex g_view_locks[16];
+
+void json_array::view() const
+{
+	if (m_packed->viewed.load(std::memory_order_acquire))
+		return;
+	std::lock_guard<std::mutex> _lock(g_view_locks[((uintptr_t)this >> 6) % 16]);
+	if (m_packed->viewed.load(std::memory_order_relaxed))
+		return;
+
+	json_resource_scope _scope(resource());
+	const size_t _count = m_packed->count;
+	m_data.clear();
+	m_data.reserve(_count);
+	char _buffer[32];
+	switch (m_packed->type)
+	{
+	case json_packed_type::float32:
+		for (float n : floats())
+			m_data.emplace_back((json_number)n);
+		break;
+	case json_packed_type::float64:
+		for (double n : doubles())
+		{
+			if (!std::isfinite(n))
+			{
+				m_data.emplace_back((json_number)n);
+				continue;
+			}
+			std::to_chars_result _r = std::to_chars(_buffer, _buffer + sizeof(_buffer), n);
+			m_data.emplace_back(json_number_text(_buffer, (size_t)(_r.ptr - _buffer)));
+		}
+		break;
+	default:
+		for (int64_t n : integers())
+		{
+			std::to_chars_result _r = std::to_chars(_buffer, _buffer + sizeof(_buffer), n);
+			m_data.emplace_back(json_number_text(_buffer, (size_t)(_r.ptr - _buffer)));
+		}
+		break;
+	}
+	m_packed->viewed.store(true, std::memory_order_release);
+}
+
+std::span<const float> json_array::floats() const
+{
+	if (packed_type() != json_packed_type::float32)
+		return {};
+	return { static_cast<const float*>(m_packed->data()), m_packed->count };
+}
+
+std::span<const double> json_array::doubles() const
+{
+	if (packed_type() != json_packed_type::float64)
+		return {};
+	return { static_cast<const double*>(m_packed->data()), m_packed->count };
+}
+
+std::span<const int64_t> json_array::integers() const
+{
+	if (packed_type() != json_packed_type::int64)
+		return {};
+	return { static_cast<const int64_t*>(m_packed->data()), m_packed->count };
+}
+
+// the elements made by a const access would not follow the writes
+std::span<float> json_array::floats()
+{
+	lend(json_lent_memory);
+	if (packed_type() != json_packed_type::float32)
+		return {};
+	drop_view();
+	return { static_cast<float*>(m_packed->data()), m_packed->count };
+}
+
+std::span<double> json_array::doubles()
+{
+	lend(json_lent_memory);
+	if (packed_type() != json_packed_type::float64)
+		return {};
+	drop_view();
+	return { static_cast<double*>(m_packed->data()), m_packed->count };
+}
+
+std::span<int64_t> json_array::integers()
+{
+	lend(json_lent_memory);
+	if (packed_type() != json_packed_type::int64)
+		return {};
+	drop_view();
+	return { static_cast<int64_t*>(m_packed->data()), m_packed->count };
+}
+
+double json_array::to_double(size_t index) const
+{
+	JSON_ASSERT(index < count(), "json_array : index out of range");
+	switch (packed_type())
+	{
+	case json_packed_type::float32:	return floats()[index];
+	case json_packed_type::float64:	return doubles()[index];
+	case json_packed_type::int64:	return (double)integers()[index];
+	default:						return m_data[index].to_double();
+	}
+}
+
+double json_array::sum() const
+{
+	switch (packed_type())
+	{
+	case json_packed_type::float32:	return json_sum_run(floats().data(), count());
+	case json_packed_type::float64:	return json_sum_run(doubles().data(), count());
+	case json_packed_type::int64:	return json_sum_run(integers().data(), count());
+	default: break;
+	}
+	double _sum = 0.0;
+	for (const json_var& var : m_data)
+		_sum += var.to_double();
+	return _sum;
+}
+
+std::optional<double> json_array::min() const
+{
+	if (count() == 0)
+		return std::nullopt;
+	switch (packed_type())
+	{
+	case json_packed_type::float32:	return json_min_run(floats().data(), count());
+	case json_packed_type::float64:	return json_min_run(doubles().data(), count());
+	case json_packed_type::int64:	return json_min_run(integers().data(), count());
+	default: break;
+	}
+	double _min = m_data[0].to_double();
+	for (size_t i = 1; i < m_data.size(); i++)
+		_min = std::fmin(_min, m_data[i].to_double());
+	return _min;
+}
+
+std::optional<double> json_array::max() const
+{
+	if (count() == 0)
+		return std::nullopt;
+	switch (packed_type())
+	{
+	case json_packed_type::float32:	return json_max_run(floats().data(), count());
+	case json_packed_type::float64:	return json_max_run(doubles().data(), count());
+	case json_packed_type::int64:	return json_max_run(integers().data(), count());
+	default: break;
+	}
+	double _max = m_data[0].to_double();
+	for (size_t i = 1; i < m_data.size(); i++)
+		_max = std::fmax(_max, m_data[i].to_double());
+	return _max;
+}
+
+bool json_array::pack()
+{
+	if (m_packed != nullptr)
+		return true;
+	if (m_data.empty())
+		return false;
+
+	bool _lazy = false, _integers = true;
+	for (const json_var& v : m_data)
+	{
+		if (!v.is_number())
+			return false;
+		if (v.lazy)
+		{
+			_lazy = true;
+			int64_t _n;
+			std::string_view _text = v.number_text();
+			std::from_chars_result _r = std::from_chars(_text.data(), _text.data() + _text.size(), _n);
+			_integers = _integers && _r.ec == std::errc() && _r.ptr == _text.data() + _text.size();
+		}
+		else
+			_integers = false;
+	}
+
+	invalidate();
+	const size_t _count = m_data.size();
+	if (!_lazy)
+	{
+		float *_p = static_cast<float*>(allocate_packed(json_packed_type::float32, _count)->data());
+		for (size_t i = 0; i < _count; i++)
+			_p[i] = m_data[i].to_number();
+	}
+	else if (_integers)
+	{
+		int64_t *_p = static_cast<int64_t*>(allocate_packed(json_packed_type::int64, _count)->data());
+		for (size_t i = 0; i < _count; i++)
+			_p[i] = m_data[i].to_integer();
+	}
+	else
+	{
+		double *_p = static_cast<double*>(allocate_packed(json_packed_type::float64, _count)->data());
+		for (size_t i = 0; i < _count; i++)
+			_p[i] = m_data[i].to_double();
+	}
+	m_data.clear();
+	return true;
+}
+
+void json_array::unpack()
+{
+	if (m_packed == nullptr)
+		return;
+	invalidate();
+	view();
+	free_packed();
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_object
+//////////////////////////////////////////////////////////////////////////
+
+json_object::json_object()
+	: m_keys(resource()), m_vars(resource())
+{
+}
+
+json_object::json_object(const json_object& obj)
+	: json_node(obj), m_keys(obj.m_keys, resource()), m_vars(obj.m_vars, resource())
+{
+}
+
+json_var& json_object::get(std::string_view key)
+{
+	lend();
+	size_t i;
+	for (i = 0; i < m_keys.size(); i++)
+		if (m_keys[i] == key)
+			break;
+	if (i == m_keys.size())
+	{
+		m_keys.emplace_back(key.data(), key.size());
+		m_vars.emplace_back();
+	}
+	return m_vars[i];
+}
+
+const json_var& json_object::get(std::string_view key) const
+{
+	static const json_var _null;
+	for (size_t i = 0; i < m_keys.size(); i++)
+		if (m_keys[i] == key)
+			return m_vars[i];
+	JSON_ASSERT(false, "json_object : key not found");
+	return _null;
+}
+
+bool json_object::has(std::string_view key) const
+{
+	for (size_t i = 0; i < m_keys.size(); i++)
+		if (m_keys[i] == key)
+			return true;
+	return false;
+}
+
+bool json_object::remove(std::string_view key)
+{
+	invalidate();
+	for (size_t i = 0; i < m_keys.size(); i++)
+		if (m_keys[i] == key)
+		{
+			m_keys.erase(m_keys.begin() + i);
+			m_vars.erase(m_vars.begin() + i);
+			return true;
+		}
+	return false;
+}
+
+json_var& json_object::operator[](std::string_view key)
+{
+	return get(key);
+}
+
+const json_var& json_object::operator[](std::string_view key) const
+{
+	return get(key);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	helper functions
+//////////////////////////////////////////////////////////////////////////
+
+// nodes are placed in memory from the current resource and give it back
+// to the resource they recorded when they were created
+template <typename T, typename... A>
+static T* create(A&&... args)
+{
+	void *_p = json_get_resource()->allocate(sizeof(T), alignof(T));
+	return new (_p) T(std::forward<A>(args)...);
+}
+
+template <typename T>
+static void destroy(T *node)
+{
+	std::pmr::memory_resource *_r = node->resource();
+	node->~T();
+	_r->deallocate(node, sizeof(T), alignof(T));
+}
+
+json_object* create_object(const json_object& obj)
+{
+	return create<json_object>(obj);
+}
+
+json_array* create_array(const std::initializer_list<json_var>& list)
+{
+	return create<json_array>(list);
+}
+
+json_array* create_array(const json_array& arr)
+{
+	return create<json_array>(arr);
+}
+
+json_string* create_string(const char* str)
+{
+	return create<json_string>(str);
+}
+
+json_string* create_string(const std::string& str)
+{
+	return create<json_string>(str);
+}
+
+json_string* create_string(const json_string& str)
+{
+	return create<json_string>(str);
+}
+
+json_string* create_string(std::string_view str)
+{
+	return create<json_string>(str.data(), str.size());
+}
+
+json_number_text* create_number_text(const json_number_text& number)
+{
+	return create<json_number_text>(number);
+}
+
+// containers released while another one is destroyed wait in a list
+// instead of being destroyed from inside it, the native stack stays flat
+// whatever the depth of the tree. the list belongs to the outermost call,
+// only a plain pointer is thread_local: thread_local storage is destroyed
+// before the static json_vars that may still need the list at exit
+static thread_local std::vector<json_var> *g_released = nullptr;
+
+static void destroy_container(json_var& var)
+{
+	if (g_released != nullptr)
+	{
+		g_released->emplace_back(std::move(var));
+		return;
+	}
+
+	std::vector<json_var> _released;
+	g_released = &_released;
+	json_var _var = std::move(var);
+	for (;;)
+	{
+		if (_var.type == json_type::object)
+			destroy(_var.value.object);
+		else
+			destroy(_var.value.array);
+		if (_released.empty())
+			break;
+		_var.value = _released.back().value;
+		_var.type = _released.back().type;
+		_released.back().type = json_type::null;
+		_released.pop_back();
+	}
+	_var.type = json_type::null;
+	g_released = nullptr;
+}
+
+void clean(json_var& var)
+{
+	if (var.type == json_type::object && var.value.object->release())
+		destroy_container(var);
+	else if (var.type == json_type::array && var.value.array->release())
+		destroy_container(var);
+	else if (var.type == json_type::string && var.value.string->release())
+		destroy(var.value.string);
+	else if (var.lazy && var.value.text->release())
+		destroy(var.value.text);
+	var.type = json_type::null;
+	var.lazy = false;
+}
+
+// shares the node of var (JSON_ENABLE_COW) or clones the whole subtree.
+// a node that handed out a reference for writing is cloned all the same,
+// a write through the reference would otherwise show in the copy. its
+// children are copied the same way, the ones never lent stay shared.
+static void copy(json_var& dst, const json_var& var)
+{
+	dst.type = var.type;
+	dst.lazy = var.lazy;
+#if defined(JSON_ENABLE_COW)
+	const json_node *_n = var.node();
+	if (_n != nullptr && _n->lent() == json_lent_none)
+	{
+		dst.value = var.value;
+		dst.node()->retain();
+		return;
+	}
+	if (_n == nullptr && dst.lazy)
+	{
+		dst.value = var.value;
+		dst.value.text->retain();
+		return;
+	}
+#endif
+	if (dst.type == json_type::object)
+		dst.value.object = create_object(*var.value.object);
+	else if (dst.type == json_type::array)
+		dst.value.array = create_array(*var.value.array);
+	else if (dst.type == json_type::string)
+		dst.value.string = create_string(*var.value.string);
+	else if (dst.lazy)
+		dst.value.text = create_number_text(*var.value.text);
+	else
+		dst.value = var.value;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	json_var
+//////////////////////////////////////////////////////////////////////////
+
+json_var::json_var()
+{
+	type = json_type::null;
+}
+
+json_var::json_var(const std::nullptr_t& t)
+{
+	type = json_type::null;
+}
+
+json_var::json_var(const json_var& var)
+{
+	copy(*this, var);
+}
+
+json_var::json_var(const json_object& obj)
+{
+	type = json_type::object;
+	value.object = create_object(obj);
+}
+
+json_var::json_var(const std::initializer_list<json_var>& list)
+{
+	type = json_type::array;
+	value.array = create_array(list);
+}
+
+json_var::json_var(const json_array& arr)
+{
+	type = json_type::array;
+	value.array = create_array(arr);
+}
+
+json_var::json_var(const char *str)
+{
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+json_var::json_var(const std::string& str)
+{
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+json_var::json_var(std::string_view str)
+{
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+json_var::json_var(const json_string& str)
+{
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+json_var::json_var(const json_boolean boolean)
+{
+	type = json_type::boolean;
+	value.boolean = boolean;
+}
+
+json_var::json_var(const json_number number)
+{
+	type = json_type::number;
+	value.number = number;
+}
+
+json_var::json_var(const json_number_text& number)
+{
+	type = json_type::number;
+	lazy = true;
+	value.text = create_number_text(number);
+}
+
+json_var::json_var(json_var&& var) noexcept
+{
+	type = var.type;
+	lazy = var.lazy;
+	value = var.value;
+	var.type = json_type::null;
+	var.lazy = false;
+}
+
+json_var::~json_var()
+{
+	clean(*this);
+}
+
+const json_node* json_var::node() const
+{
+	if (type == json_type::object)
+		return value.object;
+	else if (type == json_type::array)
+		return value.array;
+	else if (type == json_type::string)
+		return value.string;
+	return nullptr;
+}
+
+void json_var::clone_node()
+{
+	json_var _old(std::move(*this));
+	type = _old.type;
+	if (type == json_type::object)
+		value.object = create_object(*_old.value.object);
+	else if (type == json_type::array)
+		value.array = create_array(*_old.value.array);
+	else if (type == json_type::string)
+		value.string = create_string(*_old.value.string);
+}
+
+json_var& json_var::get(size_t index)
+{
+	return to_array()[index];
+}
+
+json_var& json_var::get(std::string_view key)
+{
+	return to_object().get(key);
+}
+
+const json_var& json_var::get(size_t index) const
+{
+	JSON_ASSERT(is_array(), "json_var : not an array");
+	return to_array()[index];
+}
+
+const json_var& json_var::get(std::string_view key) const
+{
+	JSON_ASSERT(is_object(), "json_var : not an object");
+	return to_object().get(key);
+}
+
+const json_key& json_var::get_key(size_t index) const
+{
+	JSON_ASSERT(is_object(), "json_var : not an object");
+	return to_object().get_key(index);
+}
+
+double json_var::to_double() const
+{
+	JSON_ASSERT(is_number(), "json_var : not a number");
+	return lazy ? value.text->to_double() : (double)value.number;
+}
+
+int64_t json_var::to_integer() const
+{
+	JSON_ASSERT(is_number(), "json_var : not a number");
+	return lazy ? value.text->to_integer() : to_int64(value.number);
+}
+
+std::string_view json_var::number_text() const
+{
+	return lazy ? value.text->text() : std::string_view();
+}
+
+void json_var::operator=(const std::nullptr_t & t)
+{
+	json_epoch_advance();
+	clean(*this);
+	type = json_type::null;
+}
+
+void json_var::operator=(const json_var& var)
+{
+	json_epoch_advance();
+	if (this == &var)
+		return;
+	json_var _old(std::move(*this));
+	copy(*this, var);
+}
+
+void json_var::operator=(const json_object& obj)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::object;
+	value.object = create_object(obj);
+}
+
+void json_var::operator=(const std::initializer_list<json_var>& list)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::array;
+	value.array = create_array(list);
+}
+
+void json_var::operator=(const json_array& arr)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::array;
+	value.array = create_array(arr);
+}
+
+void json_var::operator=(const char *str)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+void json_var::operator=(const std::string& str)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+void json_var::operator=(std::string_view str)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+void json_var::operator=(const json_string& str)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::string;
+	value.string = create_string(str);
+}
+
+void json_var::operator=(json_boolean boolean)
+{
+	json_epoch_advance();
+	clean(*this);
+	type = json_type::boolean;
+	value.boolean = boolean;
+}
+
+void json_var::operator=(json_number number)
+{
+	json_epoch_advance();
+	clean(*this);
+	type = json_type::number;
+	value.number = number;
+}
+
+void json_var::operator=(const json_number_text& number)
+{
+	json_epoch_advance();
+	json_var _old(std::move(*this));
+	type = json_type::number;
+	lazy = true;
+	value.text = create_number_text(number);
+}
+
+void json_var::operator=(json_var&& var) noexcept
+{
+	json_epoch_advance();
+	if (this == &var)
+		return;
+	// var may live in the tree being replaced, it is released last
+	json_var _old(std::move(*this));
+	type = var.type;
+	lazy = var.lazy;
+	value = var.value;
+	var.type = json_type::null;
+	var.lazy = false;
+}
+
+json_var::operator json_object&()
+{
+	return to_object();
+}
+
+json_var::operator json_array&()
+{
+	return to_array();
+}
+
+json_var::operator json_string&()
+{
+	return to_string();
+}
+
+json_var::operator json_boolean()
+{
+	return to_boolean();
+}
+
+json_var::operator json_number()
+{
+	return to_number();
+}
+
+json_var& json_var::operator[](size_t index)
+{
+	JSON_ASSERT(is_array() || is_object(), "json_var : not an array nor an object");
+	if (is_array())
+		return to_array()[index];
+	else
+		return to_object()[index];
+}
+
+json_var& json_var::operator[](std::string_view key)
+{
+	if (is_null())
+		*this = json_object();
+	return to_object()[key];
+}
+
+const json_var& json_var::operator[](size_t index) const
+{
+	JSON_ASSERT(is_array() || is_object(), "json_var : not an array nor an object");
+	if (is_array())
+		return to_array()[index];
+	else
+		return to_object()[index];
+}
+
+const json_var& json_var::operator[](std::string_view key) const
+{
+	JSON_ASSERT(is_object(), "json_var : not an object");
+	return to_object()[key];
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	hashing and equality
+//////////////////////////////////////////////////////////////////////////
+
+// splitmix64 finalizer
+static inline uint64_t mix(uint64_t h)
+{
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ull;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebull;
+	h ^= h >> 31;
+	return h;
+}
+
+static inline uint64_t hash_bytes(const char *str, size_t length)
+{
+	return mix((uint64_t)std::hash<std::string_view>()(std::string_view(str, length)) + length);
+}
+
+// a number as the value it holds, whatever it is stored as: an int64_t when
+// it is a whole number that fits, a double otherwise. the integers of a
+// lazy number are read from its text, so they stay exact past 2^53.
+struct json_number_key
+{
+	bool integral;
+	int64_t integer;
+	double number;
+
+	inline bool operator==(const json_number_key& k) const { return integral ? k.integral && integer == k.integer : !k.integral && number == k.number; }
+};
+
+static inline json_number_key number_key(double n)
+{
+	// -0 is 0, the bounds are -2^63 and 2^63
+	if (n >= -9223372036854775808.0 && n < 9223372036854775808.0 && n == std::trunc(n))
+		return { true, (int64_t)n, 0 };
+	return { false, 0, n };
+}
+
+static json_number_key number_key(const json_var& var)
+{
+	if (!var.lazy)
+		return number_key((double)var.value.number);
+	const std::string_view _text = var.value.text->text();
+	int64_t _n;
+	const std::from_chars_result _r = std::from_chars(_text.data(), _text.data() + _text.size(), _n);
+	if (_r.ec == std::errc() && _r.ptr == _text.data() + _text.size())
+		return { true, _n, 0 };
+	return number_key(var.value.text->to_double());
+}
+
+// an element of an array of numbers, packed or not
+static json_number_key number_key(const json_array& arr, size_t index)
+{
+	switch (arr.packed_type())
+	{
+	case json_packed_type::float32:	return number_key((double)arr.floats()[index]);
+	case json_packed_type::float64:	return number_key(arr.doubles()[index]);
+	case json_packed_type::int64:	return { true, arr.integers()[index], 0 };
+	default:						return number_key(arr[index]);
+	}
+}
+
+static inline uint64_t hash_number(const json_number_key& key)
+{
+	if (key.integral)
+		return mix(((uint64_t)4 << 32) + (uint64_t)key.integer);
+	uint64_t _bits;
+	memcpy(&_bits, &key.number, sizeof(_bits));
+	return mix(mix(8) + _bits);
+}
+
+// a container being hashed. like the writer, hashing keeps them on a stack
+// of its own rather than on the native stack so any depth can be hashed.
+// hash is the running hash of an array, the sum of the members of an object.
+struct json_hash_frame
+{
+	const json_node *node;
+	size_t index;
+	size_t count;
+	bool object;
+	uint64_t hash;
+	uint64_t epoch;
+	json_lent lent;		// the worst node of the subtree so far, see json_node
+};
+
+typedef std::vector<json_hash_frame> json_hash_stack;
+
+// the hash of var when it needs no frame: a scalar, a string or a container
+// whose hash is cached. lent is raised to the worst node of the subtree, it
+// tells how long the hash holds
+static bool hash_leaf(const json_var& var, json_lent& lent, uint64_t& hash)
+{
+	switch (var.type)
+	{
+	case json_type::null:
+		hash = mix(1);
+		return true;
+	case json_type::boolean:
+		hash = mix(var.value.boolean ? 3 : 2);
+		return true;
+	case json_type::number:
+		hash = hash_number(number_key(var));
+		return true;
+	default:
+		break;
+	}
+
+	const json_node *_node = var.node();
+	json_lent _lent = json_lent_none;
+	hash = _node->cached_hash(_lent);
+	if (hash == 0 && var.is_string())
+	{
+		const uint64_t _epoch = json_epoch_take();
+		_lent = _node->lent();
+		hash = hash_bytes(var.value.string->get(), var.value.string->size()) ^ 5;
+		if (hash == 0)
+			hash = 1;
+		_node->cache_hash(hash, _lent, _epoch);
+	}
+	if (hash == 0)
+		return false;
+	lent = std::max(lent, _lent);
+	return true;
+}
+
+static void push_hash_frame(json_hash_stack& stack, const json_var& var)
+{
+	// taken first, a write during the walk leaves the hash out of date
+	json_hash_frame _f{ var.node(), 0, 0, var.is_object(), 0, json_epoch_take(), var.node()->lent() };
+	if (_f.object)
+		_f.count = var.value.object->count();
+	else
+	{
+		const json_array& _arr = *var.value.array;
+		_f.count = _arr.count();
+		_f.hash = 6 + _arr.count();
+		if (_arr.is_packed())
+		{
+			// the same as the elements a const access would make
+			for (size_t i = 0; i < _arr.count(); i++)
+				_f.hash = mix(_f.hash + hash_number(number_key(_arr, i)));
+			_f.index = _f.count;
+		}
+	}
+	stack.push_back(_f);
+}
+
+// adds the hash of the value at the index of the top frame and moves on
+static void fold_hash(json_hash_frame& frame, uint64_t hash)
+{
+	if (frame.object)
+	{
+		// a sum does not depend on the order of the members
+		const json_key& _key = static_cast<const json_object*>(frame.node)->get_key(frame.index);
+		frame.hash += mix(hash_bytes(_key.data(), _key.size()) ^ (hash * 0x9e3779b97f4a7c15ull));
+	}
+	else
+		frame.hash = mix(frame.hash + hash);
+	frame.index++;
+}
+
+static uint64_t hash_of(const json_var& var, json_lent& lent)
+{
+	uint64_t _hash;
+	if (hash_leaf(var, lent, _hash))
+		return _hash;
+
+	json_hash_stack _stack;
+	push_hash_frame(_stack, var);
+	for (;;)
+	{
+		json_hash_frame& _f = _stack.back();
+		if (_f.index < _f.count)
+		{
+			const json_var& _var = _f.object ? (*static_cast<const json_object*>(_f.node))[_f.index] : (*static_cast<const json_array*>(_f.node))[_f.index];
+			if (hash_leaf(_var, _f.lent, _hash))
+				fold_hash(_f, _hash);
+			else
+				push_hash_frame(_stack, _var);
+			continue;
+		}
+
+		_hash = _f.object ? mix(7 + _f.count + _f.hash) : _f.hash;
+		if (_hash == 0)
+			_hash = 1;
+		_f.node->cache_hash(_hash, _f.lent, _f.epoch);
+		const json_lent _lent = _f.lent;
+		_stack.pop_back();
+		if (_stack.empty())
+		{
+			lent = std::max(lent, _lent);
+			return _hash;
+		}
+		_stack.back().lent = std::max(_stack.back().lent, _lent);
+		fold_hash(_stack.back(), _hash);
+	}
+}
+
+uint64_t json_hash(const json_var& var)
+{
+	json_lent _lent = json_lent_none;
+	return hash_of(var, _lent);
+}
+
+// a pair of containers being compared, kept on a stack like the writer does
+struct json_equal_frame
+{
+	const json_node *a;
+	const json_node *b;
+	size_t index;
+	size_t count;
+	bool object;
+};
+
+// compares a and b without their elements or members, descend is set when
+// those are still to be compared
+static bool equal_shallow(const json_var& a, const json_var& b, bool& descend)
+{
+	descend = false;
+	if (a.type != b.type)
+		return false;
+
+	switch (a.type)
+	{
+	case json_type::null:
+		return true;
+	case json_type::boolean:
+		return a.value.boolean == b.value.boolean;
+	case json_type::number:
+		return number_key(a) == number_key(b);
+	default:
+		break;
+	}
+
+	if (a.node() == b.node())
+		return true;
+	if (json_hash(a) != json_hash(b))
+		return false;
+
+	if (a.is_string())
+		return *a.value.string == *b.value.string;
+
+	if (a.is_array())
+	{
+		const json_array& _a = *a.value.array;
+		const json_array& _b = *b.value.array;
+		if (_a.count() != _b.count())
+			return false;
+		if (_a.is_packed() || _b.is_packed())
+		{
+			// packed numbers are compared without making the elements
+			for (size_t i = 0; i < _a.count(); i++)
+			{
+				if (!_a.is_packed() && !_a[i].is_number())
+					return false;
+				if (!_b.is_packed() && !_b[i].is_number())
+					return false;
+				if (!(number_key(_a, i) == number_key(_b, i)))
+					return false;
+			}
+			return true;
+		}
+		descend = _a.count() > 0;
+		return true;
+	}
+
+	if (a.value.object->count() != b.value.object->count())
+		return false;
+	descend = a.value.object->count() > 0;
+	return true;
+}
+
+bool operator==(const json_var& a, const json_var& b)
+{
+	bool _descend;
+	if (!equal_shallow(a, b, _descend))
+		return false;
+
+	std::vector<json_equal_frame> _stack;
+	if (_descend)
+		_stack.push_back({ a.node(), b.node(), 0, a.is_object() ? a.value.object->count() : a.value.array->count(), a.is_object() });
+	while (!_stack.empty())
+	{
+		json_equal_frame& _f = _stack.back();
+		if (_f.index == _f.count)
+		{
+			_stack.pop_back();
+			continue;
+		}
+
+		const size_t i = _f.index++;
+		const json_var *_a, *_b;
+		if (_f.object)
+		{
+			// members are looked for at the same position first
+			const json_object& _oa = *static_cast<const json_object*>(_f.a);
+			const json_object& _ob = *static_cast<const json_object*>(_f.b);
+			const json_key& _key = _oa.get_key(i);
+			_a = &_oa[i];
+			if (_ob.get_key(i) == _key)
+				_b = &_ob[i];
+			else if (_ob.has(_key))
+				_b = &_ob.get(_key);
+			else
+				return false;
+		}
+		else
+		{
+			_a = &(*static_cast<const json_array*>(_f.a))[i];
+			_b = &(*static_cast<const json_array*>(_f.b))[i];
+		}
+
+		if (!equal_shallow(*_a, *_b, _descend))
+			return false;
+		if (_descend)
+			_stack.push_back({ _a->node(), _b->node(), 0, _a->is_object() ? _a->value.object->count() : _a->value.array->count(), _a->is_object() });
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// helper functions
+//////////////////////////////////////////////////////////////////////////
+
+static inline void write_string(std::ostream& stream, const json_string& str)
+{
+	JSON_STATS(node(json_type::string));
+	json_write_string(stream, str.get(), str.size());
+}
+
+static inline void write_key(std::ostream& stream, const json_key& key)
+{
+	json_write_string(stream, key.data(), key.size());
+	stream << " : ";
+}
+
+// JSON has no representation for infinities and NaN, they are written as null
+static inline void write_number(std::ostream& stream, json_number n)
+{
+	if (std::isfinite(n))
+		stream << n;
+	else
+		stream << "null";
+}
+
+static inline void write_tabs(std::ostream& stream, int indent)
+{
+	for (int j = 0; j < indent; j++)
+		stream << "\t";
+}
+
+// the pieces of the writer are also used by json_write_parallel, which
+// cuts a document at the same places and so writes the same bytes.
+// a member is written as its open part, its value and its close part.
+void json_write_member_open(std::ostream& stream, const json_object& obj, size_t index, int indent)
+{
+	write_tabs(stream, indent);
+	write_key(stream, obj.get_key(index));
+	if (obj[index].is_object())
+	{
+		stream << "\n";
+		write_tabs(stream, indent);
+		stream << "{\n";
+	}
+}
+
+void json_write_member_close(std::ostream& stream, const json_object& obj, size_t index, int indent)
+{
+	const bool _last = index + 1 == obj.count();
+	if (obj[index].is_string())
+		stream << (_last ? "\n" : ",\n");
+	else if (!obj[index].is_object())
+	{
+		if (!_last)
+			stream << ",\n";
+	}
+	else
+	{
+		stream << "\n";
+		write_tabs(stream, indent);
+		stream << (_last ? "}" : "},\n");
+	}
+}
+
+// an element is written as its open part, its value and its close part
+void json_write_element_open(std::ostream& stream, const json_array& arr, size_t index)
+{
+	if (arr[index].is_object())
+		stream << "{\n";
+}
+
+void json_write_element_close(std::ostream& stream, const json_array& arr, size_t index)
+{
+	if (arr[index].is_object())
+		stream << "\n}";
+	if (index + 1 < arr.count())
+		stream << ", ";
+}
+
+// a value that is not written through a frame
+static void write_value(std::ostream& stream, const json_var& var)
+{
+	if (var.is_string())
+		write_string(stream, var.to_string());
+	else
+	{
+		JSON_STATS(node(var.type));
+		if (var.type == json_type::array)
+			stream << "[]";
+		else if (var.lazy)
+			stream << var.value.text->text();
+		else if (var.type == json_type::number)
+			write_number(stream, var.value.number);
+		else if (var.type == json_type::boolean)
+			stream << (var.value.boolean ? "true" : "false");
+		else
+			stream << "null";
+	}
+}
+
+// the elements of a packed array from first to last, with their separators.
+// floats are written like the other numbers, doubles and int64_t like the
+// lazy numbers a const access would make of them.
+static void write_packed(std::ostream& stream, const json_array& arr, size_t first, size_t last)
+{
+	char _buffer[32];
+	for (size_t i = first; i < last; i++)
+	{
+		JSON_STATS(node(json_type::number));
+		if (arr.packed_type() == json_packed_type::float32)
+			write_number(stream, arr.floats()[i]);
+		else if (arr.packed_type() == json_packed_type::int64)
+		{
+			std::to_chars_result _r = std::to_chars(_buffer, _buffer + sizeof(_buffer), arr.integers()[i]);
+			stream.write(_buffer, _r.ptr - _buffer);
+		}
+		else if (std::isfinite(arr.doubles()[i]))
+		{
+			std::to_chars_result _r = std::to_chars(_buffer, _buffer + sizeof(_buffer), arr.doubles()[i]);
+			stream.write(_buffer, _r.ptr - _buffer);
+		}
+		else
+			stream << "null";
+		if (i + 1 < arr.count())
+			stream << ", ";
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// writer
+//////////////////////////////////////////////////////////////////////////
+
+// a container being written, or a run of its members or elements. the
+// writer keeps them on a stack of its own rather than on the native stack
+// so any depth can be written. pending is set while the value at index is
+// written by the frame above, its close part is still to be written.
+struct json_write_frame
+{
+	const json_node *node;
+	size_t index;
+	size_t last;
+	int indent;
+	bool object;
+	bool whole;		// the whole container, an array then goes between brackets
+	bool pending;
+	std::ostream *out;
+#if defined(JSON_ENABLE_WRITE_CACHE)
+	// a miss writes the container on the side, see push_frame
+	std::ostream *parent;
+	std::unique_ptr<std::ostringstream> buffer;
+	uint64_t key;
+	uint64_t epoch;
+	json_lent lent;		// the worst node written so far, see json_node
+#endif
+};
+
+typedef std::vector<json_write_frame> json_write_stack;
+
+// starts writing a container into out. with JSON_ENABLE_WRITE_CACHE a whole
+// container whose bytes were kept is copied and no frame is pushed, on a
+// miss it is written on the side, with the formatting of out, and its
+// bytes are kept when they are worth it. the nested containers are cached
+// on the way, down to JSON_WRITE_CACHE_DEPTH, so after a change only the
+// path to it is written again. like the hashes, bytes over a subtree that
+// lent a reference hold until the next write, see json_node.
+static void push_frame(json_write_stack& stack, std::ostream& out, const json_node& node, bool object, size_t first, size_t last, int indent, bool whole)
+{
+	json_write_frame _f{ &node, first, last, indent, object, whole, false, &out };
+#if defined(JSON_ENABLE_WRITE_CACHE)
+	_f.parent = &out;
+	_f.lent = node.lent();
+	if (whole && stack.size() < JSON_WRITE_CACHE_DEPTH)
+	{
+		_f.key = (uint64_t)(uint32_t)indent | (uint64_t)(out.precision() & 0xffff) << 32 | (uint64_t)(out.flags() & 0xffff) << 48;
+		json_lent _lent;
+		if (node.write_cached(_f.key, out, _lent))
+		{
+			if (!stack.empty())
+				stack.back().lent = std::max(stack.back().lent, _lent);
+			return;
+		}
+		// taken first, a write meanwhile leaves the bytes out of date
+		_f.epoch = json_epoch_take();
+		_f.buffer = std::make_unique<std::ostringstream>();
+		_f.buffer->copyfmt(out);
+		_f.out = _f.buffer.get();
+	}
+#endif
+	if (whole)
+	{
+		if (object)
+			JSON_STATS(node(json_type::object));
+		if (last > first)
+			JSON_STATS(enter());
+		if (!object)
+			*_f.out << "[ ";
+	}
+	stack.push_back(std::move(_f));
+}
+
+static void pop_frame(json_write_stack& stack)
+{
+	json_write_frame& _f = stack.back();
+	if (_f.whole)
+	{
+		if (!_f.object)
+			*_f.out << " ]";
+		if (_f.last > 0)
+			JSON_STATS(leave());
+	}
+#if defined(JSON_ENABLE_WRITE_CACHE)
+	if (_f.buffer != nullptr)
+	{
+		const std::string _str = _f.buffer->str();
+		if (_str.size() >= JSON_WRITE_CACHE_MIN)
+			_f.node->cache_write(_f.key, _str, _f.lent, _f.epoch);
+		_f.parent->write(_str.data(), (std::streamsize)_str.size());
+	}
+	const json_lent _lent = _f.lent;
+	stack.pop_back();
+	if (!stack.empty())
+		stack.back().lent = std::max(stack.back().lent, _lent);
+#else
+	stack.pop_back();
+#endif
+}
+
+// starts the value at the index of the top frame, a container gets a frame
+// of its own and the top frame waits for it to close
+static void write_item(json_write_stack& stack)
+{
+	json_write_frame& _f = stack.back();
+	std::ostream& _out = *_f.out;
+	const size_t i = _f.index;
+
+	if (_f.object)
+	{
+		const json_object& _obj = *static_cast<const json_object*>(_f.node);
+		const json_var& _var = _obj[i];
+		json_write_member_open(_out, _obj, i, _f.indent);
+		const int _indent = _f.indent + 1;
+		if (_var.is_object())
+		{
+			_f.pending = true;
+			push_frame(stack, _out, *_var.value.object, true, 0, _var.value.object->count(), _indent, true);
+		}
+		else if (_var.is_array() && _var.value.array->count() > 0)
+		{
+			JSON_STATS(node(json_type::array));
+			_f.pending = true;
+			push_frame(stack, _out, *_var.value.array, false, 0, _var.value.array->count(), 0, true);
+		}
+		else
+		{
+#if defined(JSON_ENABLE_WRITE_CACHE)
+			if (_var.node() != nullptr)
+				_f.lent = std::max(_f.lent, _var.node()->lent());
+#endif
+			write_value(_out, _var);
+			json_write_member_close(_out, _obj, i, _f.indent);
+			_f.index++;
+		}
+	}
+	else
+	{
+		const json_array& _arr = *static_cast<const json_array*>(_f.node);
+		if (_arr.is_packed())
+		{
+			write_packed(_out, _arr, i, _f.last);
+			_f.index = _f.last;
+			return;
+		}
+		const json_var& _var = _arr[i];
+		json_write_element_open(_out, _arr, i);
+		if (_var.is_object())
+		{
+			_f.pending = true;
+			push_frame(stack, _out, *_var.value.object, true, 0, _var.value.object->count(), 1, true);
+		}
+		else if (_var.is_array() && _var.value.array->count() > 0)
+		{
+			JSON_STATS(node(json_type::array));
+			_f.pending = true;
+			push_frame(stack, _out, *_var.value.array, false, 0, _var.value.array->count(), 0, true);
+		}
+		else
+		{
+#if defined(JSON_ENABLE_WRITE_CACHE)
+			if (_var.node() != nullptr)
+				_f.lent = std::max(_f.lent, _var.node()->lent());
+#endif
+			write_value(_out, _var);
+			json_write_element_close(_out, _arr, i);
+			_f.index++;
+		}
+	}
+}
+
+static void write_frames(json_write_stack& stack)
+{
+	while (!stack.empty())
+	{
+		json_write_frame& _f = stack.back();
+		if (_f.pending)
+		{
+			if (_f.object)
+				json_write_member_close(*_f.out, *static_cast<const json_object*>(_f.node), _f.index, _f.indent);
+			else
+				json_write_element_close(*_f.out, *static_cast<const json_array*>(_f.node), _f.index);
+			_f.index++;
+			_f.pending = false;
+		}
+		if (_f.index == _f.last)
+			pop_frame(stack);
+		else
+			write_item(stack);
+	}
+}
+
+void json_write_members(std::ostream& stream, const json_object& obj, size_t first, size_t last, int indent)
+{
+	json_write_stack _stack;
+	push_frame(_stack, stream, obj, true, first, last, indent, false);
+	write_frames(_stack);
+}
+
+void json_write_elements(std::ostream& stream, const json_array& arr, size_t first, size_t last)
+{
+	json_write_stack _stack;
+	push_frame(_stack, stream, arr, false, first, last, 0, false);
+	write_frames(_stack);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//	operators
+//////////////////////////////////////////////////////////////////////////
+
+std::ostream& operator<<(std::ostream& stream, const json_string& str)
+{
+	stream.write(str.get(), (std::streamsize)str.size());
+	return stream;
+}
+
+std::ostream& operator<<(std::ostream& stream, const json_array& arr)
+{
+	if (arr.count() == 0)
+	{
+		stream << "[]";
+		return stream;
+	}
+	json_write_stack _stack;
+	push_frame(_stack, stream, arr, false, 0, arr.count(), 0, true);
+	write_frames(_stack);
+	return stream;
+}
+
+std::ostream& operator<<(std::ostream& stream, const json_object& obj)
+{
+	stream << "{\n";
+	json_write_stack _stack;
+	push_frame(_stack, stream, obj, true, 0, obj.count(), 1, true);
+	write_frames(_stack);
+	stream << "\n}";
+	return stream;
+}
+
+std::ostream& operator<<(std::ostream& stream, const json_var& var)
+{
+	if (var.type != json_type::object)
+		JSON_STATS(node(var.type));
+	if (var.type == json_type::array)
+		stream << *var.value.array;
+	else if (var.type == json_type::string)
+		stream << *var.value.string;
+	else if (var.lazy)
+		stream << var.value.text->text();
+	else if (var.type == json_type::number)
+		write_number(stream, var.value.number);
+	else if (var.type == json_type::boolean)
+		stream << (var.value.boolean ? "true" : "false");
+	else if (var.type == json_type::null)
+		stream << "null";
+	else if (var.type == json_type::object)
+		stream << *var.value.object;
+	return stream;
 }
\ No newline at end of file
@@ -0,0 +1,239 @@
+/*
+
+Copyright 2021 (C) Benali Louarrani <mtlm3014@gmail.com>
+
+This file is part of OpenJSON.
+
+OpenJSON is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenJSON is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenJSON.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include <json/json_watch.h>
+#include <json/json_doc.h>
+
+#if defined(JSON_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// json_watched_doc
+//////////////////////////////////////////////////////////////////////////
+
+json_watched_doc::json_watched_doc(const std::string& file, const json_watch_options& options)
+	: m_file(file), m_options(options), m_index(0), m_readers{ 0, 0 }, m_version(0), m_stop(false), m_check(false), m_pipe{ -1, -1 }
+{
+	load();
+#if defined(JSON_PLATFORM_LINUX)
+	if (pipe2(m_pipe, O_CLOEXEC | O_NONBLOCK) != 0)
+		m_pipe[0] = m_pipe[1] = -1;
+#endif
+	m_thread = std::thread([this]() { if (!watch()) poll(); });
+}
+
+json_watched_doc::~json_watched_doc()
+{
+	{
+		std::lock_guard<std::mutex> _lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	wake();
+	m_thread.join();
+#if defined(JSON_PLATFORM_LINUX)
+	if (m_pipe[0] >= 0)
+	{
+		close(m_pipe[0]);
+		close(m_pipe[1]);
+	}
+#endif
+}
+
+json_parse_result json_watched_doc::error() const
+{
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	return m_error;
+}
+
+json_watched_doc::handle json_watched_doc::get() const
+{
+	for (;;)
+	{
+		const uint32_t i = m_index.load();
+		m_readers[i].fetch_add(1);
+		if (m_index.load() == i)
+		{
+			handle _doc = m_slots[i];
+			m_readers[i].fetch_sub(1, std::memory_order_release);
+			return _doc;
+		}
+		m_readers[i].fetch_sub(1, std::memory_order_release);
+	}
+}
+
+// called by the watcher only. the other slot is written once its last
+// reader left and published, then the previous slot is emptied as soon as
+// its readers left, so the version it held lives on in snapshots only.
+void json_watched_doc::publish(const handle& doc)
+{
+	const uint32_t _old = m_index.load(std::memory_order_relaxed);
+	const uint32_t _new = 1 - _old;
+	while (m_readers[_new].load() != 0)
+		std::this_thread::yield();
+	m_slots[_new] = doc;
+	m_index.store(_new);
+	while (m_readers[_old].load() != 0)
+		std::this_thread::yield();
+	m_slots[_old].reset();
+}
+
+void json_watched_doc::reload()
+{
+	{
+		std::lock_guard<std::mutex> _lock(m_mutex);
+		m_check = true;
+	}
+	m_wake.notify_all();
+	wake();
+}
+
+void json_watched_doc::wake()
+{
+#if defined(JSON_PLATFORM_LINUX)
+	if (m_pipe[1] >= 0)
+	{
+		const char _byte = 0;
+		(void)!write(m_pipe[1], &_byte, 1);
+	}
+#endif
+}
+
+// parses the file when its stamp changed and publishes it, returns true
+// when a new version was published
+bool json_watched_doc::load()
+{
+	json_file_stamp _stamp;
+	if (!json_file_stamp_of(m_file.c_str(), _stamp))
+	{
+		m_stamp = json_file_stamp();
+		std::lock_guard<std::mutex> _lock(m_mutex);
+		m_error = json_parse_result();
+		m_error.code = json_parse_error::cannot_read;
+		return false;
+	}
+	if (_stamp == m_stamp)
+		return false;
+	m_stamp = _stamp;
+
+	std::shared_ptr<json_var> _doc = std::make_shared<json_var>();
+	json_parse_result _result;
+	const bool _success = json_doc::load_file(m_file.c_str(), *_doc, _result);
+	if (_success)
+	{
+		publish(_doc);
+		m_version.fetch_add(1, std::memory_order_acq_rel);
+	}
+	std::lock_guard<std::mutex> _lock(m_mutex);
+	m_error = _result;
+	return _success;
+}
+
+// checks the stamp every interval
+void json_watched_doc::poll()
+{
+	std::unique_lock<std::mutex> _lock(m_mutex);
+	while (!m_stop)
+	{
+		m_wake.wait_for(_lock, m_options.interval, [this]() { return m_stop || m_check; });
+		if (m_stop)
+			break;
+		m_check = false;
+		_lock.unlock();
+		load();
+		_lock.lock();
+	}
+}
+
+// waits for the events of the directory of the file, a change is parsed
+// once no event came for the delay. returns false when inotify is not
+// available or fails.
+bool json_watched_doc::watch()
+{
+#if defined(JSON_PLATFORM_LINUX)
+	if (m_pipe[0] < 0)
+		return false;
+	const int _fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if (_fd < 0)
+		return false;
+
+	const size_t _slash = m_file.rfind('/');
+	const std::string _dir = _slash == std::string::npos ? "." : _slash == 0 ? "/" : m_file.substr(0, _slash);
+	const std::string _name = _slash == std::string::npos ? m_file : m_file.substr(_slash + 1);
+	if (inotify_add_watch(_fd, _dir.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB) < 0)
+	{
+		close(_fd);
+		return false;
+	}
+
+	alignas(struct inotify_event) char _events[4096];
+	bool _pending = false;
+	for (;;)
+	{
+		struct pollfd _fds[2] = { { _fd, POLLIN, 0 }, { m_pipe[0], POLLIN, 0 } };
+		const int _ready = ::poll(_fds, 2, _pending ? (int)m_options.delay.count() : -1);
+		if (_ready < 0 && errno != EINTR)
+		{
+			// left to poll()
+			close(_fd);
+			return false;
+		}
+
+		bool _now = false;
+		if (_fds[1].revents & POLLIN)
+		{
+			char _drain[64];
+			while (read(m_pipe[0], _drain, sizeof(_drain)) > 0);
+			std::lock_guard<std::mutex> _lock(m_mutex);
+			if (m_stop)
+				break;
+			_now = m_check;
+			m_check = false;
+		}
+		if (_fds[0].revents & POLLIN)
+		{
+			ssize_t _size;
+			while ((_size = read(_fd, _events, sizeof(_events))) > 0)
+				for (char *p = _events; p < _events + _size; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len)
+				{
+					const struct inotify_event *_event = (const struct inotify_event*)p;
+					if (_event->len > 0 && _name == _event->name)
+						_pending = true;
+				}
+		}
+
+		if (_now || (_ready == 0 && _pending))
+		{
+			_pending = false;
+			load();
+		}
+	}
+	close(_fd);
+	return true;
+#else
+	return false;
+#endif
+}
\ No newline at end of file
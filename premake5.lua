@@ -1,11 +1,12 @@
-workspace "OpenJSON"
-	architecture ("x64", "x86")
-	startproject "Sandbox"
-	configurations
-	{
-		"Debug",
-		"Release"
-	}
-
-	include "Sandbox"
-	include "OpenJSON"
\ No newline at end of file
+workspace "OpenJSON"
+	architecture ("x64", "x86")
+	startproject "Sandbox"
+	configurations
+	{
+		"Debug",
+		"Release"
+	}
+
+	include "Sandbox"
+	include "OpenJSON"
+	include "Benchmarks"
\ No newline at end of file